@@ -12,12 +12,16 @@
 #include <string.h>
 #include "mpt/mpt.h"
 #include "data_structures/vector.h"
+#include "data_structures/arena.h"
 #include "operators.h"
 #include "shunting_yard.h"
 
 /** Makro s hodnotou vyhodnocení příkazu pro ukončení programu */
 #define QUIT_CODE -1
 
+/** Makro s počtem znaků, po kterých se načítaný řádek přidává do vektoru */
+#define LINE_CHUNK_SIZE 256
+
 /** Makra pro úspěšnost vyhodnocení příkazu */
 
 #define EVALUATION_FAILURE 0
@@ -70,6 +74,46 @@ static int streq_ignorecase_(char const *str1, char const *str2) {
     return tolower(*str1) == tolower(*str2);
 }
 
+/**
+ * \brief Přečte kladné celé číslo z proměnné prostředí.
+ * \param name Název proměnné prostředí.
+ * \return size_t Hodnota proměnné, 0 pokud proměnná není nastavená nebo neobsahuje kladné číslo.
+ */
+static size_t env_size_(const char *name) {
+    const char *value = getenv(name);
+    char *end = NULL;
+    unsigned long parsed;
+
+    if (!value || !*value) {
+        return 0;
+    }
+
+    parsed = strtoul(value, &end, 10);
+    return *end == 0 ? (size_t)parsed : 0;
+}
+
+/** 
+ * @brief Nastaví prahy násobicích a dělicích algoritmů podle proměnných prostředí MPT_KARATSUBA_THRESHOLD,
+ *        MPT_TOOM3_THRESHOLD, MPT_FFT_THRESHOLD a MPT_BZ_THRESHOLD.
+ *        Umožňuje vyladit kalkulačku pro konkrétní stroj bez nového překladu (doporučené hodnoty vypíše nástroj mpt_tune).
+*/
+void init_thresholds(void) {
+    size_t threshold;
+
+    if ((threshold = env_size_("MPT_KARATSUBA_THRESHOLD"))) {
+        mpt_set_karatsuba_threshold(threshold);
+    }
+    if ((threshold = env_size_("MPT_TOOM3_THRESHOLD"))) {
+        mpt_set_toom3_threshold(threshold);
+    }
+    if ((threshold = env_size_("MPT_FFT_THRESHOLD"))) {
+        mpt_set_fft_threshold(threshold);
+    }
+    if ((threshold = env_size_("MPT_BZ_THRESHOLD"))) {
+        mpt_set_bz_threshold(threshold);
+    }
+}
+
 /** 
  * @brief Vrátí stream, se kterým bude kalkulačka pracovat.
  * @param argc Počet parametrů z příkazové řádky.
@@ -97,40 +141,41 @@ FILE *init_stream(const int argc, char *argv[]) {
 }
 
 /** 
- * @brief Načte řádek ze streamu a uloží ho jako řetězec do vektoru.
+ * @brief Načte řádek ze streamu a uloží ho jako řetězec do vektoru. Znaky se sbírají do lokálního bloku
+ *        a do vektoru se přidávají po LINE_CHUNK_SIZE najednou. Na konci streamu zůstane vektor prázdný.
  * @param stream Stream, ze kterého čteme.
  * @param dest Ukazatel na vektor.
  * @return int 1 jestli se podařilo řádek načíst, jinak 0.
 */
 int load_line(FILE *stream, vector_type *dest) {
-    int c_int;
-    char c = 0;
+    char chunk[LINE_CHUNK_SIZE];
+    size_t used = 0;
+    int c_int, read = 0;
 
     if (!stream || !dest || !vector_isempty(dest)) {
         return 0;
     }
 
     while ((c_int = getc(stream)) != EOF) {
-        c = (char)c_int;
-        if (is_end_char_(c)) {
-            c = 0;
-        }
-        if (!vector_push_back(dest, &c)) {
-            return 0;
-        }
-        if (c == 0) {
+        read = 1;
+        if (is_end_char_((char)c_int)) {
             break;
         }
+        chunk[used++] = (char)c_int;
+        if (used == LINE_CHUNK_SIZE) {
+            if (!vector_append_n(dest, chunk, used)) {
+                return 0;
+            }
+            used = 0;
+        }
     }
 
-    if (c != 0) {
-        c = 0;
-        if (!vector_push_back(dest, &c)) {
-            return 0;
-        }
+    if (!read) {
+        return 1;
     }
 
-    return 1;
+    chunk[used++] = 0;
+    return vector_append_n(dest, chunk, used);
 }
 
 /** 
@@ -147,18 +192,23 @@ void print_out(const enum bases out) {
 }
 
 /** 
- * @brief Vyhodnotí zadaný matematický výraz.
+ * @brief Vyhodnotí zadaný matematický výraz. Parser, vyhodnocování RPN výrazu i mezivýsledky mpt berou paměť z arény,
+ *        která se po vyhodnocení uvolní najednou. Výsledek se vypíše ještě předtím, z arény proto nic nemusí přežít.
+ *        Pomocná paměť operací je v kontextu, který přežívá mezi výrazy.
  * @param input Řetězec s výrazem.
  * @param out Ukazatel na aktuální číselnou soustavu.
+ * @param arena Ukazatel na arénu pro paměť výrazu.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí operací mpt.
  * @return int s hodnotou některého z maker pro úspěšnost výsledku (viz shunting_yard.h).
 */
-int evaluate_expression(const char *input, const enum bases *out) {
+int evaluate_expression(const char *input, const enum bases *out, arena_type *arena, mpt_ctx *ctx) {
     int res;
     int evaluation_res = EVALUATION_FAILURE;
     vector_type *rpn_str = NULL;
     stack_type *values = NULL;
+    arena_type *previous_arena = arena_activate(arena);
     mpt result;
-    result.list = NULL;
+    result.size = 0;
 
     switch (res = shunt(input, &rpn_str, &values)) {
         case INVALID_SYMBOL: printf("Invalid command \"%s\"!\n", input); break;
@@ -171,7 +221,7 @@ int evaluate_expression(const char *input, const enum bases *out) {
         goto clean_and_exit;
     }
 
-    switch (res = evaluate_rpn(&result, rpn_str, values)) {
+    switch (res = evaluate_rpn(&result, rpn_str, values, ctx)) {
         case SYNTAX_ERROR:          printf("Syntax error!\n"); break;
         case MATH_ERROR:            printf("Math error!\n"); break;
         case DIV_BY_ZERO:           printf("Division by zero!\n"); break;
@@ -179,7 +229,7 @@ int evaluate_expression(const char *input, const enum bases *out) {
         case ERROR:                 printf("Error while evaluating!\n"); break;
         default: 
             evaluation_res = EVALUATION_SUCCESS;
-            mpt_print(result, *out);
+            mpt_print_ctx(result, *out, ctx);
             printf("\n");
             break;
     }
@@ -189,6 +239,9 @@ int evaluate_expression(const char *input, const enum bases *out) {
     stack_deallocate(&values);
     mpt_deinit(&result);
 
+    arena_activate(previous_arena);
+    arena_reset(arena);
+
     return evaluation_res;
 }
 
@@ -196,9 +249,11 @@ int evaluate_expression(const char *input, const enum bases *out) {
  * @brief Vyhodnotí zadaný příkaz.
  * @param input Řetězec s výrazem.
  * @param out Ukazatel na aktuální číselnou soustavu.
+ * @param arena Ukazatel na arénu pro paměť výrazu.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí operací mpt.
  * @return int s hodnotou některého z maker pro vyhodnocení příkazu (viz začátek calc.c).
 */
-int evaluate_command(const char *input, enum bases *out) {
+int evaluate_command(const char *input, enum bases *out, arena_type *arena, mpt_ctx *ctx) {
     if (!out) {
         return EVALUATION_FAILURE;
     }
@@ -226,7 +281,7 @@ int evaluate_command(const char *input, enum bases *out) {
     SET_OUT_IF(streq_ignorecase_(input, "dec"), dec);
     SET_OUT_IF(streq_ignorecase_(input, "hex"), hex);
 
-    return evaluate_expression(input, out);
+    return evaluate_expression(input, out, arena, ctx);
 
     #undef SET_OUT_IF
 }
@@ -243,6 +298,8 @@ int main(int argc, char *argv[]) {
     enum bases out = dec;
     vector_type *input_vector = NULL;
     FILE *stream = NULL;
+    arena_type arena;
+    mpt_ctx ctx;
 
     #define FAIL_IF_NOT(v) \
         if (!(v)) { \
@@ -250,6 +307,10 @@ int main(int argc, char *argv[]) {
             goto clean_and_exit; \
         }
 
+    init_thresholds();
+    arena_init(&arena);
+    mpt_ctx_init(&ctx);
+
     FAIL_IF_NOT(input_vector = vector_allocate(sizeof(char), NULL));
     FAIL_IF_NOT(stream = init_stream(argc, argv));
 
@@ -266,7 +327,7 @@ int main(int argc, char *argv[]) {
             printf("%s\n", input);
         }
 
-        if (evaluate_command(input, &out) == QUIT_CODE) {
+        if (evaluate_command(input, &out, &arena, &ctx) == QUIT_CODE) {
             break;
         }
 
@@ -284,6 +345,8 @@ int main(int argc, char *argv[]) {
 
   clean_and_exit:
     vector_deallocate(&input_vector);
+    arena_deinit(&arena);
+    mpt_ctx_deinit(&ctx);
     if (stream) {
         fclose(stream);
     }
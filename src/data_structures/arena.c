@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+/** Počet jednotek (velikost arena_header) v jednom bloku arény. */
+#define ARENA_BLOCK_UNITS (ARENA_BLOCK_SIZE / sizeof(arena_header))
+
+/** Aktivní aréna, NULL pokud se přiděluje z haldy. */
+static arena_type *active_ = NULL;
+
+/**
+ * \brief Vrátí počet jednotek (velikost arena_header), do kterých se vejde zadaný počet bajtů.
+ * \param size Počet bajtů.
+ * \return size_t Počet jednotek.
+ */
+static size_t units_(const size_t size) {
+    return (size + sizeof(arena_header) - 1) / sizeof(arena_header);
+}
+
+/**
+ * \brief Přidělí paměť z haldy s hlavičkou bez vlastníka.
+ * \param size Velikost paměti v bajtech.
+ * \return void* Ukazatel na paměť za hlavičkou nebo NULL při chybě.
+ */
+static void *heap_alloc_(const size_t size) {
+    arena_header *header;
+
+    if (size > (size_t)-1 - sizeof(arena_header)) {
+        return NULL;
+    }
+    if (!(header = (arena_header *)malloc(sizeof(arena_header) + size))) {
+        return NULL;
+    }
+    header->info.size = size;
+    header->info.owner = NULL;
+
+    return header + 1;
+}
+
+/**
+ * \brief Přidělí paměť z arény. Velké alokace přesměruje na haldu, aby po nich v aréně nezůstávala nevyužitá místa.
+ * \param arena Ukazatel na arénu.
+ * \param size Velikost paměti v bajtech.
+ * \return void* Ukazatel na paměť za hlavičkou nebo NULL při chybě.
+ */
+static void *arena_alloc_(arena_type *arena, const size_t size) {
+    const size_t units = units_(size) + 1;
+    arena_block *block = arena->blocks;
+    arena_header *header;
+
+    if (size > ARENA_LARGE_SIZE) {
+        return heap_alloc_(size);
+    }
+
+    if (!block || block->size - block->used < units) {
+        if (!(block = (arena_block *)malloc(offsetof(arena_block, data) + ARENA_BLOCK_UNITS * sizeof(arena_header)))) {
+            return NULL;
+        }
+        block->size = ARENA_BLOCK_UNITS;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    header = block->data + block->used;
+    block->used += units;
+    header->info.size = size;
+    header->info.owner = arena;
+    arena->last = header;
+
+    return header + 1;
+}
+
+void arena_init(arena_type *arena) {
+    if (!arena) {
+        return;
+    }
+
+    arena->blocks = NULL;
+    arena->last = NULL;
+}
+
+void arena_reset(arena_type *arena) {
+    arena_block *block;
+
+    if (!arena || !arena->blocks) {
+        return;
+    }
+
+    while (arena->blocks->next) {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+    arena->blocks->used = 0;
+    arena->last = NULL;
+}
+
+void arena_deinit(arena_type *arena) {
+    arena_block *block;
+
+    if (!arena) {
+        return;
+    }
+
+    while (arena->blocks) {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        free(block);
+    }
+    arena->last = NULL;
+}
+
+arena_type *arena_activate(arena_type *arena) {
+    arena_type *previous = active_;
+    active_ = arena;
+    return previous;
+}
+
+void *arena_malloc(const size_t size) {
+    return active_ ? arena_alloc_(active_, size) : heap_alloc_(size);
+}
+
+void *arena_calloc(const size_t count, const size_t size) {
+    void *ptr;
+
+    if (size != 0 && count > (size_t)-1 / size) {
+        return NULL;
+    }
+    if ((ptr = arena_malloc(count * size)) != NULL) {
+        memset(ptr, 0, count * size);
+    }
+
+    return ptr;
+}
+
+void *arena_realloc(void *ptr, const size_t size) {
+    arena_header *header;
+    arena_type *arena;
+    arena_block *block;
+    void *moved;
+
+    if (!ptr) {
+        return arena_malloc(size);
+    }
+
+    header = (arena_header *)ptr - 1;
+    arena = header->info.owner;
+
+    if (!arena) {
+        if (size > (size_t)-1 - sizeof(arena_header)) {
+            return NULL;
+        }
+        if (!(header = (arena_header *)realloc(header, sizeof(arena_header) + size))) {
+            return NULL;
+        }
+        header->info.size = size;
+        return header + 1;
+    }
+
+    /* Poslední alokace se zmenší nebo zvětší posunutím konce bloku */
+    block = arena->blocks;
+    if (arena->last == header && size <= ARENA_LARGE_SIZE &&
+        (size_t)(header - block->data) + units_(size) + 1 <= block->size) {
+        block->used = (size_t)(header - block->data) + units_(size) + 1;
+        header->info.size = size;
+        return ptr;
+    }
+    if (size <= header->info.size) {
+        header->info.size = size;
+        return ptr;
+    }
+
+    if (!(moved = arena_alloc_(arena, size))) {
+        return NULL;
+    }
+    memcpy(moved, ptr, header->info.size);
+    arena_free(ptr);
+
+    return moved;
+}
+
+void arena_free(void *ptr) {
+    arena_header *header;
+    arena_type *arena;
+
+    if (!ptr) {
+        return;
+    }
+
+    header = (arena_header *)ptr - 1;
+    arena = header->info.owner;
+
+    if (!arena) {
+        free(header);
+    } else if (arena->last == header) {
+        arena->blocks->used = (size_t)(header - arena->blocks->data);
+        arena->last = NULL;
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file arena.h
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Hlavičkový soubor s deklaracemi funkcí oblastního alokátoru (arény).
+ *        Aréna přiděluje paměť posouváním ukazatele ve velkých blocích a uvolní ji najednou funkcí arena_reset.
+ *        Funkce arena_malloc, arena_calloc, arena_realloc a arena_free nahrazují funkce standardní knihovny:
+ *        pokud je aktivní aréna (viz arena_activate), přidělují paměť z ní, jinak z haldy.
+ *        Paměť získanou těmito funkcemi je nutné uvolňovat výhradně funkcí arena_free (a naopak).
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+/** @brief Velikost jednoho bloku arény v bajtech. */
+#define ARENA_BLOCK_SIZE 65536
+
+/** @brief Alokace větší než tato velikost (v bajtech) se neberou z arény, ale přímo z haldy. */
+#define ARENA_LARGE_SIZE 16384
+
+/**
+ * @brief Hlavička před každou přidělenou pamětí. Sjednocení s long double zaručuje zarovnání paměti za hlavičkou
+ *        pro libovolný typ.
+ */
+typedef union arena_header_ {
+    struct {
+        size_t size;                /** Požadovaná velikost paměti v bajtech. */
+        struct arena_type_ *owner;  /** Aréna, ze které paměť pochází, NULL pro paměť z haldy. */
+    } info;
+    long double align;
+} arena_header;
+
+/**
+ * @brief Blok paměti arény. Bloky tvoří zřetězený seznam od nejnovějšího, přiděluje se vždy z prvního.
+ */
+typedef struct arena_block_ {
+    struct arena_block_ *next;  /** Předchozí (starší) blok. */
+    size_t size;                /** Počet jednotek (velikost arena_header) v bloku. */
+    size_t used;                /** Počet přidělených jednotek. */
+    arena_header data[1];       /** Začátek dat bloku. */
+} arena_block;
+
+/**
+ * @brief Oblastní alokátor.
+ */
+typedef struct arena_type_ {
+    arena_block *blocks;        /** Nejnovější blok, NULL pokud aréna ještě nic nepřidělila. */
+    arena_header *last;         /** Hlavička poslední alokace v nejnovějším bloku, kterou lze ještě vrátit nebo zvětšit na místě. */
+} arena_type;
+
+/**
+ * @brief Inicializuje prázdnou arénu. Bloky se alokují až při prvním přidělení paměti.
+ * @param arena Ukazatel na arénu.
+ */
+void arena_init(arena_type *arena);
+
+/**
+ * @brief Najednou uvolní všechnu paměť přidělenou z arény. Nejstarší blok si aréna ponechá pro další použití.
+ *        Ukazatele na paměť z arény jsou poté neplatné.
+ * @param arena Ukazatel na arénu.
+ */
+void arena_reset(arena_type *arena);
+
+/**
+ * @brief Uvolní všechny bloky arény.
+ * @param arena Ukazatel na arénu.
+ */
+void arena_deinit(arena_type *arena);
+
+/**
+ * @brief Nastaví arénu, ze které budou přidělovat funkce arena_malloc, arena_calloc a arena_realloc.
+ * @param arena Ukazatel na arénu, NULL pro přidělování z haldy.
+ * @return arena_type* Dosud aktivní aréna, kterou lze po skončení výpočtu obnovit.
+ */
+arena_type *arena_activate(arena_type *arena);
+
+/**
+ * @brief Přidělí paměť z aktivní arény, případně z haldy (viz malloc).
+ * @param size Velikost paměti v bajtech.
+ * @return void* Ukazatel na paměť nebo NULL při chybě.
+ */
+void *arena_malloc(const size_t size);
+
+/**
+ * @brief Přidělí vynulovanou paměť pro pole prvků (viz calloc).
+ * @param count Počet prvků.
+ * @param size Velikost jednoho prvku v bajtech.
+ * @return void* Ukazatel na paměť nebo NULL při chybě.
+ */
+void *arena_calloc(const size_t count, const size_t size);
+
+/**
+ * @brief Změní velikost paměti (viz realloc). Paměť zůstane v aréně nebo na haldě, odkud pochází;
+ *        poslední alokaci arény zvětší na místě, pokud to blok dovolí.
+ * @param ptr Ukazatel na paměť získanou funkcemi arény nebo NULL.
+ * @param size Nová velikost v bajtech.
+ * @return void* Ukazatel na paměť nebo NULL při chybě, původní paměť pak zůstane platná.
+ */
+void *arena_realloc(void *ptr, const size_t size);
+
+/**
+ * @brief Uvolní paměť (viz free). Paměť z haldy se vrátí hned, paměť z arény jen pokud jde o její poslední alokaci,
+ *        jinak zůstane přidělená do arena_reset.
+ * @param ptr Ukazatel na paměť získanou funkcemi arény nebo NULL.
+ */
+void arena_free(void *ptr);
+
+#endif
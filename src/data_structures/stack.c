@@ -1,4 +1,5 @@
 #include "stack.h"
+#include "arena.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -21,14 +22,14 @@ stack_type *stack_allocate(const size_t size, const size_t item_size, const stac
         return NULL;
     }
 
-    new = (stack_type *)malloc(sizeof(stack_type));
+    new = (stack_type *)arena_malloc(sizeof(stack_type));
     if (!new) {
         return NULL;
     }
 
-    new->items = malloc(size * item_size);
+    new->items = arena_malloc(size * item_size);
     if (!new->items) {
-        free(new);
+        arena_free(new);
         return NULL;
     }
 
@@ -80,7 +81,6 @@ int stack_isempty(const stack_type *s) {
 
 void stack_clear(stack_type *s) {
     size_t i;
-    void *item = NULL;
 
     if (s->deallocator) {
         for (i = 0; i < stack_item_count(s); ++i) {
@@ -88,7 +88,8 @@ void stack_clear(stack_type *s) {
         }
     }
 
-    while (stack_pop(s, &item));
+    /* Prvky se jen zahodí, vybírat je do pomocné proměnné by vyžadovalo paměť velikosti prvku */
+    s->sp = 0;
 }
 
 void stack_deallocate(stack_type **s) {
@@ -100,7 +101,7 @@ void stack_deallocate(stack_type **s) {
         stack_clear(*s);
     }
 
-    free((*s)->items);
-    free(*s);
+    arena_free((*s)->items);
+    arena_free(*s);
     *s = NULL;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "vector.h"
+#include "arena.h"
 
 /**
  * \brief Pracuje stejně jako funkce vector_at (viz vector.h), ale neprovádí kontrolu rozsahu přistupovaného vektoru.
@@ -26,6 +27,20 @@ static void deallocate_at_(const vector_type *v, const size_t at) {
     }
 }
 
+/**
+ * \brief Uvolní všechny prvky vektoru v, pokud má vektor dealokátor. Počet prvků ani buffer nemění.
+ * \param v Ukazatel na vektor.
+ */
+static void deallocate_items_(const vector_type *v) {
+    size_t i;
+
+    if (v->deallocator) {
+        for (i = 0; i < vector_count(v); ++i) {
+            deallocate_at_(v, i);
+        }
+    }
+}
+
 vector_type *vector_allocate(const size_t item_size, const vec_it_dealloc_type deallocator) {
     vector_type *new;
 
@@ -33,7 +48,7 @@ vector_type *vector_allocate(const size_t item_size, const vec_it_dealloc_type d
         return NULL;
     }
 
-    new = (vector_type *)malloc(sizeof(vector_type));
+    new = (vector_type *)arena_malloc(sizeof(vector_type));
     if (!new) {
         return NULL;
     }
@@ -66,20 +81,14 @@ int vector_init(vector_type *v, const size_t item_size, const vec_it_dealloc_typ
 }
 
 void vector_deinit(vector_type *v) {
-    size_t i;
-
     if (!v) {
         return;
     }
 
-    if (v->deallocator) {
-        for (i = 0; i < vector_count(v); ++i) {
-            deallocate_at_(v, i);
-        }
-    }
+    deallocate_items_(v);
 
     if (v->data) {
-        free(v->data);
+        arena_free(v->data);
     }
 }
 
@@ -87,8 +96,15 @@ int vector_clear(vector_type *v) {
     if (!v) {
         return 0;
     }
-    vector_deinit(v);
-    return vector_init(v, v->item_size, v->deallocator);
+
+    /* Buffer zůstane vektoru, opakované plnění (např. čtení řádků) tak nerealokuje */
+    deallocate_items_(v);
+    v->count = 0;
+    if (v->capacity > 0) {
+        ((char *)v->data)[0] = 0;
+    }
+
+    return 1;
 }
 
 void vector_deallocate(vector_type **v) {
@@ -98,7 +114,7 @@ void vector_deallocate(vector_type **v) {
 
     vector_deinit(*v);
 
-    free(*v);
+    arena_free(*v);
     *v = NULL;
 }
 
@@ -147,7 +163,7 @@ int vector_realloc(vector_type *v, const size_t capacity) {
         return 0;
     }
 
-    data_temp = realloc(v->data, capacity * v->item_size);
+    data_temp = arena_realloc(v->data, capacity * v->item_size);
     if (!data_temp) {
         return 0;
     }
@@ -158,6 +174,39 @@ int vector_realloc(vector_type *v, const size_t capacity) {
     return 1;
 }
 
+int vector_reserve(vector_type *v, const size_t capacity) {
+    const size_t grown = vector_capacity(v) * VECTOR_SIZE_MULT;
+
+    if (!v) {
+        return 0;
+    }
+
+    if (capacity <= vector_capacity(v)) {
+        return 1;
+    }
+
+    return vector_realloc(v, capacity > grown ? capacity : grown);
+}
+
+int vector_resize(vector_type *v, const size_t count) {
+    if (!v) {
+        return 0;
+    }
+
+    if (count < vector_count(v)) {
+        return vector_remove(v, vector_count(v) - count);
+    }
+
+    if (!vector_reserve(v, count)) {
+        return 0;
+    }
+
+    memset(vector_at_(v, v->count), 0, (count - v->count) * v->item_size);
+    v->count = count;
+
+    return 1;
+}
+
 void *vector_at(const vector_type *v, const size_t at) {
     if (at > vector_count(v) - 1) {
         return NULL;
@@ -192,10 +241,8 @@ int vector_push_back(vector_type *v, const void *item) {
         return 0;
     }
 
-    if (vector_count(v) >= vector_capacity(v)) {
-        if (!vector_realloc(v, v->capacity * VECTOR_SIZE_MULT)) {
-            return 0;
-        }
+    if (!vector_reserve(v, v->count + 1)) {
+        return 0;
     }
 
     memcpy(vector_at_(v, v->count), item, v->item_size);
@@ -204,6 +251,25 @@ int vector_push_back(vector_type *v, const void *item) {
     return 1;
 }
 
+int vector_append_n(vector_type *v, const void *items, const size_t count) {
+    if (!v || (!items && count > 0)) {
+        return 0;
+    }
+
+    if (count == 0) {
+        return 1;
+    }
+
+    if (!vector_reserve(v, v->count + count)) {
+        return 0;
+    }
+
+    memcpy(vector_at_(v, v->count), items, count * v->item_size);
+    v->count += count;
+
+    return 1;
+}
+
 void *vector_giveup(vector_type *v) {
     void *data;
 
@@ -67,7 +67,7 @@ int vector_init(vector_type *v, const size_t item_size, const vec_it_dealloc_typ
 void vector_deinit(vector_type *v);
 
 /**
- * @brief Odstraní a případně uvolní všechny prvky vektoru.
+ * @brief Odstraní a případně uvolní všechny prvky vektoru. Kapacita vektoru se zachová.
  * @param v Ukazatel na vektor, z něhož se prvky odstraňují.
  * @return int 1, pokud se odstranění prvků povedlo, jinak 0.
  */
@@ -116,6 +116,23 @@ int vector_isempty(const vector_type *v);
  */
 int vector_realloc(vector_type *v, const size_t capacity);
 
+/**
+ * @brief Zajistí, aby kapacita vektoru byla alespoň capacity. Pokud je realokace potřeba, kapacita vzroste
+ *        alespoň VECTOR_SIZE_MULT krát, opakované přidávání prvků má tak amortizovaně konstantní cenu.
+ * @param v Ukazatel na vektor.
+ * @param capacity Požadovaná nejmenší kapacita vektoru.
+ * @return int 1, pokud má vektor požadovanou kapacitu, jinak 0.
+ */
+int vector_reserve(vector_type *v, const size_t capacity);
+
+/**
+ * @brief Změní počet prvků vektoru na count. Nové prvky jsou vynulované, odebrané prvky se případně uvolní.
+ * @param v Ukazatel na vektor.
+ * @param count Nový počet prvků.
+ * @return int 1, pokud se změna povedla, jinak 0 (vektor pak není změněn).
+ */
+int vector_resize(vector_type *v, const size_t count);
+
 /**
  * @brief Vrací ukazatel na at-tý prvek vektoru v. V případě neexistence prvku vratí NULL.
  * @param v Ukazatel na vektor.
@@ -132,6 +149,15 @@ void *vector_at(const vector_type *v, const size_t at);
  */
 int vector_push_back(vector_type *v, const void *item);
 
+/**
+ * @brief Přidá na konec vektoru count prvků najednou, nejvýše jednou realokací. V případě chyby není vektor změněn.
+ * @param v Ukazatel na vektor, kam se prvky přidávají.
+ * @param items Ukazatel na pole přidávaných prvků.
+ * @param count Počet přidávaných prvků.
+ * @return int 1, pokud se přidání prvků povedlo, jinak 0.
+ */
+int vector_append_n(vector_type *v, const void *items, const size_t count);
+
 /**
  * @brief Odstraní zadaný počet prvků z konce vektoru. 
  *        Pokud je zadaný počet větší než počet prvků ve vektoru, odstraní všechny prvky.
@@ -10,8 +10,12 @@
 #define _MPT_H
 
 #include "multiple_precision_type.h"
+#include "multiple_precision_segments.h"
+#include "multiple_precision_context.h"
 #include "multiple_precision_parsing.h"
 #include "multiple_precision_printing.h"
 #include "multiple_precision_operations.h"
+#include "multiple_precision_multiplication.h"
+#include "multiple_precision_division.h"
 
 #endif
\ No newline at end of file
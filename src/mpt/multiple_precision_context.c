@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include "multiple_precision_context.h"
+#include "../data_structures/arena.h"
+
+void mpt_ctx_init(mpt_ctx *ctx) {
+    size_t i;
+
+    if (!ctx) {
+        return;
+    }
+
+    for (i = 0; i < mpt_slot_count; ++i) {
+        ctx->buffers[i] = NULL;
+        ctx->sizes[i] = 0;
+    }
+}
+
+void mpt_ctx_deinit(mpt_ctx *ctx) {
+    size_t i;
+
+    if (!ctx) {
+        return;
+    }
+
+    for (i = 0; i < mpt_slot_count; ++i) {
+        free(ctx->buffers[i]);
+        ctx->buffers[i] = NULL;
+        ctx->sizes[i] = 0;
+    }
+}
+
+void *mpt_ctx_acquire(mpt_ctx *ctx, const enum mpt_ctx_slot slot, const size_t bytes) {
+    size_t size;
+
+    if (!ctx) {
+        return arena_malloc(bytes);
+    }
+
+    /* Obsah bufferu se nezachovává, místo realloc proto stačí nová alokace, velikost roste aspoň dvojnásobně */
+    if (ctx->sizes[slot] < bytes) {
+        size = bytes > 2 * ctx->sizes[slot] ? bytes : 2 * ctx->sizes[slot];
+        free(ctx->buffers[slot]);
+        if (!(ctx->buffers[slot] = malloc(size))) {
+            ctx->sizes[slot] = 0;
+            return NULL;
+        }
+        ctx->sizes[slot] = size;
+    }
+
+    return ctx->buffers[slot];
+}
+
+void mpt_ctx_release(mpt_ctx *ctx, void *buffer) {
+    if (!ctx) {
+        arena_free(buffer);
+    }
+}
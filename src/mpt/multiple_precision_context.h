@@ -0,0 +1,67 @@
+/**
+ * @file multiple_precision_context.h
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Hlavičkový soubor s deklaracemi kontextu mpt_ctx, který vlastní pomocnou paměť operací mpt.
+ *        Kontext drží pro každý druh pomocné paměti jeden buffer, který se jen zvětšuje a přežívá mezi voláními.
+ *        Opakované výpočty se stejným kontextem proto po zahřátí pomocnou paměť vůbec nealokují.
+ *        Buffery se berou přímo z haldy, kontext tak smí přežít i uvolnění arény (viz arena.h).
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#ifndef _MPT_CONTEXT_H
+#define _MPT_CONTEXT_H
+
+#include "multiple_precision_type.h"
+
+/**
+ * @brief Druhy pomocné paměti kontextu. Operace, které se volají vnořeně (např. násobení uvnitř dělení),
+ *        používají různé buffery, aby si navzájem nepřepisovaly data.
+ */
+enum mpt_ctx_slot {
+    mpt_slot_mul,       /** Pomocná paměť Karatsubova algoritmu a algoritmu Toom-3. */
+    mpt_slot_fft,       /** Tabulka a zbytky číselně teoretické transformace. */
+    mpt_slot_div,       /** Normalizovaný dělenec, dělitel a pomocná paměť rekurzivního dělení. */
+    mpt_slot_result,    /** Výsledek operace, jejíž výsledná instance sdílí segmenty s operandem. */
+    mpt_slot_dec,       /** Dělenec, podíly, zbytky a číslice při převodu do dekadické soustavy. */
+    mpt_slot_count      /** Počet druhů pomocné paměti. */
+};
+
+/**
+ * @brief Kontext s pomocnou pamětí operací mpt.
+ */
+typedef struct mpt_ctx_ {
+    void *buffers[mpt_slot_count];  /** Buffery pomocné paměti, NULL dokud nejsou potřeba. */
+    size_t sizes[mpt_slot_count];   /** Velikosti bufferů v bajtech. */
+} mpt_ctx;
+
+/**
+ * @brief Inicializuje prázdný kontext. Buffery se alokují až při prvním použití.
+ * @param ctx Ukazatel na kontext.
+ */
+void mpt_ctx_init(mpt_ctx *ctx);
+
+/**
+ * @brief Uvolní všechny buffery kontextu.
+ * @param ctx Ukazatel na kontext.
+ */
+void mpt_ctx_deinit(mpt_ctx *ctx);
+
+/**
+ * @brief Vrátí pomocnou paměť zadaného druhu o velikosti alespoň 'bytes' bajtů. Obsah paměti není definovaný.
+ *        Bez kontextu paměť alokuje jen pro jedno použití, pak ji je nutné vrátit funkcí mpt_ctx_release.
+ * @param ctx Ukazatel na kontext, nebo NULL.
+ * @param slot Druh pomocné paměti.
+ * @param bytes Požadovaná velikost v bajtech.
+ * @return void* Ukazatel na pomocnou paměť nebo NULL při chybě.
+ */
+void *mpt_ctx_acquire(mpt_ctx *ctx, const enum mpt_ctx_slot slot, const size_t bytes);
+
+/**
+ * @brief Vrátí pomocnou paměť získanou funkcí mpt_ctx_acquire. Buffer kontextu zůstane přidělený pro další volání.
+ * @param ctx Ukazatel na kontext, nebo NULL (stejný jako při získání paměti).
+ * @param buffer Ukazatel na pomocnou paměť.
+ */
+void mpt_ctx_release(mpt_ctx *ctx, void *buffer);
+
+#endif
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+#include <string.h>
+#include "multiple_precision_division.h"
+#include "multiple_precision_multiplication.h"
+#include "multiple_precision_segments.h"
+
+/** Aktuální práh rekurzivního dělení (počet segmentů dělitele). */
+static size_t bz_threshold_ = MPT_BZ_THRESHOLD;
+
+/**
+ * \brief Spočte převrácenou hodnotu normalizovaného dělitele floor((B^2 - 1) / d) - B, kde B = 2^SEGMENT_BITS.
+ * \param d Dělitel s nastaveným nejvyšším bitem.
+ * \return segment_type Převrácená hodnota dělitele.
+ */
+static segment_type reciprocal_(const segment_type d) {
+    return (segment_type)((((double_segment_type)(segment_type)~d << SEGMENT_BITS) | (segment_type)~(segment_type)0) / d);
+}
+
+/**
+ * \brief Vydělí dvousegmentovou hodnotu (u1, u0) normalizovaným dělitelem s předpočtenou převrácenou hodnotou
+ *        (Möller–Granlund) a místo dělení použije jen násobení.
+ * \param rem Ukazatel, kam se zapíše zbytek.
+ * \param u1 Vyšší segment dělence, musí být menší než dělitel.
+ * \param u0 Nižší segment dělence.
+ * \param d Dělitel s nastaveným nejvyšším bitem.
+ * \param inv Převrácená hodnota dělitele z funkce reciprocal_.
+ * \return segment_type Podíl.
+ */
+static segment_type div_preinv_(segment_type *rem, const segment_type u1, const segment_type u0, const segment_type d, const segment_type inv) {
+    double_segment_type q = (double_segment_type)inv * u1 + (((double_segment_type)u1 << SEGMENT_BITS) | u0);
+    segment_type q1 = (segment_type)(q >> SEGMENT_BITS) + 1, q0 = (segment_type)q, r;
+
+    r = u0 - q1 * d;
+    if (r > q0) {
+        --q1;
+        r += d;
+    }
+    if (r >= d) {
+        ++q1;
+        r -= d;
+    }
+
+    *rem = r;
+    return q1;
+}
+
+segment_type mpt_divrem_1_segments(segment_type *q, const segment_type *a, const size_t n, const segment_type d) {
+    segment_type inv, norm, rem = 0, low, digit;
+    unsigned int shift = 0;
+    size_t i;
+
+    if (!a || n == 0 || d == 0) {
+        return 0;
+    }
+
+    for (norm = d; !(norm >> (SEGMENT_BITS - 1)); norm <<= 1) {
+        ++shift;
+    }
+    inv = reciprocal_(norm);
+
+    /* Dělenec se posouvá o stejný počet bitů jako dělitel průběžně, vysunuté bity tvoří počáteční zbytek */
+    if (shift) {
+        rem = a[n - 1] >> (SEGMENT_BITS - shift);
+    }
+
+    for (i = n; i-- > 0;) {
+        low = a[i] << shift;
+        if (shift && i > 0) {
+            low |= a[i - 1] >> (SEGMENT_BITS - shift);
+        }
+
+        digit = div_preinv_(&rem, rem, low, norm, inv);
+        if (q) {
+            q[i] = digit;
+        }
+    }
+
+    return rem >> shift;
+}
+
+/**
+ * \brief Školní dělení normalizovaných hodnot (Knuthův algoritmus D). Zbytek zůstane v nejnižších nv segmentech 'u'.
+ * \param q Ukazatel na segmenty podílu (nu - nv), nebo NULL.
+ * \param u Ukazatel na segmenty dělence (nu), jeho nejvyšších nv segmentů musí být menších než dělitel.
+ * \param nu Počet segmentů dělence.
+ * \param v Ukazatel na segmenty dělitele (nv >= 2) s nastaveným nejvyšším bitem.
+ * \param nv Počet segmentů dělitele.
+ */
+static void div_basecase_(segment_type *q, segment_type *u, const size_t nu, const segment_type *v, const size_t nv) {
+    const segment_type v1 = v[nv - 1], v2 = v[nv - 2];
+    double_segment_type part, rhat;
+    segment_type qhat;
+    size_t j;
+
+    for (j = nu - nv; j-- > 0;) {
+        /* Odhad číslice podílu z nejvyšších dvou segmentů, skutečná číslice se vždy vejde do segmentu */
+        part = ((double_segment_type)u[j + nv] << SEGMENT_BITS) | u[j + nv - 1];
+        if (u[j + nv] >= v1) {
+            qhat = ~(segment_type)0;
+            rhat = part - (double_segment_type)qhat * v1;
+        } else {
+            qhat = (segment_type)(part / v1);
+            rhat = part % v1;
+        }
+
+        /* Oprava odhadu pomocí třetího segmentu, po ní je odhad nejvýše o 1 větší než skutečná číslice */
+        while ((rhat >> SEGMENT_BITS) == 0 && (double_segment_type)qhat * v2 > ((rhat << SEGMENT_BITS) | u[j + nv - 2])) {
+            --qhat;
+            rhat += v1;
+        }
+
+        if (mpt_submul_1_segments(u + j, v, nv, qhat) > u[j + nv]) {
+            --qhat;
+            mpt_add_n_segments(u + j, u + j, v, nv);
+        }
+        u[j + nv] = 0;
+
+        if (q) {
+            q[j] = qhat;
+        }
+    }
+}
+
+/**
+ * \brief Školní dělení, které připouští i nejvyšších nv segmentů dělence větších nebo rovných děliteli.
+ *        V takovém případě je podíl o jedna větší, než se vejde do nu - nv segmentů, a přebytek se vrátí v 'qh'.
+ * \param q Ukazatel na segmenty podílu (nu - nv).
+ * \param qh Ukazatel, kam se zapíše nejvyšší segment podílu (0 nebo 1).
+ * \param u Ukazatel na segmenty dělence (nu), zbytek zůstane v jeho nejnižších nv segmentech.
+ * \param nu Počet segmentů dělence.
+ * \param v Ukazatel na segmenty normalizovaného dělitele (nv >= 2).
+ * \param nv Počet segmentů dělitele.
+ */
+static void div_sb_(segment_type *q, segment_type *qh, segment_type *u, const size_t nu, const segment_type *v, const size_t nv) {
+    if ((*qh = mpt_cmp_n_segments(u + nu - nv, v, nv) >= 0)) {
+        mpt_sub_n_segments(u + nu - nv, u + nu - nv, v, nv);
+    }
+
+    div_basecase_(q, u, nu, v, nv);
+}
+
+static int div_dc_n_(segment_type *q, segment_type *qh, segment_type *u, const segment_type *v, const size_t n, segment_type *tmp, mpt_ctx *ctx);
+
+/**
+ * \brief Vydělí 2n segmentů n segmenty školním nebo rekurzivním dělením podle nastaveného prahu.
+ * \return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+static int div_2n_by_n_(segment_type *q, segment_type *qh, segment_type *u, const segment_type *v, const size_t n, segment_type *tmp, mpt_ctx *ctx) {
+    if (n < bz_threshold_) {
+        div_sb_(q, qh, u, 2 * n, v, n);
+        return 1;
+    }
+
+    return div_dc_n_(q, qh, u, v, n, tmp, ctx);
+}
+
+/**
+ * \brief Rekurzivní dělení 2n segmentů n segmenty (Burnikel–Ziegler). Každou polovinu podílu odhadne
+ *        dělením horní polovinou dělitele a zbytek opraví odečtením součinu odhadu s dolní polovinou dělitele.
+ *        Podíl je tak nejvýše o malou konstantu větší než skutečný a opravuje se přičítáním dělitele.
+ * \param q Ukazatel na segmenty podílu (n).
+ * \param qh Ukazatel, kam se zapíše nejvyšší segment podílu (0 nebo 1).
+ * \param u Ukazatel na segmenty dělence (2n), zbytek zůstane v jeho nejnižších n segmentech.
+ * \param v Ukazatel na segmenty normalizovaného dělitele.
+ * \param n Počet segmentů dělitele.
+ * \param tmp Pomocná paměť o n segmentech.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí pro násobení, nebo NULL.
+ * \return int 1 pokud se operace podařila, 0 pokud se nepodařilo vynásobit mezivýsledky.
+ */
+static int div_dc_n_(segment_type *q, segment_type *qh, segment_type *u, const segment_type *v, const size_t n, segment_type *tmp, mpt_ctx *ctx) {
+    const size_t lo = n / 2, hi = n - lo;
+    segment_type ql, borrow;
+
+    /* Horních hi segmentů podílu z horních 2hi segmentů dělence a horních hi segmentů dělitele */
+    if (!div_2n_by_n_(q + lo, qh, u + 2 * lo, v + lo, hi, tmp, ctx) || !mpt_mul_segments(tmp, q + lo, hi, v, lo, ctx)) {
+        return 0;
+    }
+
+    borrow = mpt_sub_n_segments(u + lo, u + lo, tmp, n);
+    if (*qh) {
+        borrow += mpt_sub_n_segments(u + n, u + n, v, lo);
+    }
+    while (borrow) {
+        *qh -= mpt_sub_1_segments(q + lo, q + lo, hi, 1);
+        borrow -= mpt_add_n_segments(u + lo, u + lo, v, n);
+    }
+
+    /* Dolních lo segmentů podílu ze zbytku po horní části */
+    if (!div_2n_by_n_(q, &ql, u + hi, v + hi, lo, tmp, ctx) || !mpt_mul_segments(tmp, v, hi, q, lo, ctx)) {
+        return 0;
+    }
+
+    borrow = mpt_sub_n_segments(u, u, tmp, n);
+    if (ql) {
+        borrow += mpt_sub_n_segments(u + lo, u + lo, v, hi);
+    }
+    while (borrow) {
+        mpt_sub_1_segments(q, q, lo, 1);
+        borrow -= mpt_add_n_segments(u, u, v, n);
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Rekurzivní dělení normalizovaných hodnot libovolné délky. Podíl se počítá po blocích o nv segmentech
+ *        od nejvyšších řádů, první (neúplný) blok o k segmentech se odhadne dělením horními k segmenty dělitele.
+ * \param q Ukazatel na segmenty podílu (nu - nv).
+ * \param u Ukazatel na segmenty dělence (nu), jeho nejvyšších nv segmentů musí být menších než dělitel.
+ * \param nu Počet segmentů dělence.
+ * \param v Ukazatel na segmenty normalizovaného dělitele.
+ * \param nv Počet segmentů dělitele.
+ * \param tmp Pomocná paměť o nv segmentech.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí pro násobení, nebo NULL.
+ * \return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+static int div_dc_(segment_type *q, segment_type *u, const size_t nu, const segment_type *v, const size_t nv, segment_type *tmp, mpt_ctx *ctx) {
+    size_t k = (nu - nv) % nv, pos;
+    segment_type qh, borrow;
+
+    if (k == 0) {
+        k = nv;
+    }
+    pos = nu - nv - k;
+
+    if (k < bz_threshold_) {
+        div_sb_(q + pos, &qh, u + pos, nv + k, v, nv);
+    } else {
+        if (!div_2n_by_n_(q + pos, &qh, u + pos + nv - k, v + nv - k, k, tmp, ctx)) {
+            return 0;
+        }
+
+        if (k != nv) {
+            if (!mpt_mul_segments(tmp, q + pos, k, v, nv - k, ctx)) {
+                return 0;
+            }
+
+            borrow = mpt_sub_n_segments(u + pos, u + pos, tmp, nv);
+            if (qh) {
+                borrow += mpt_sub_n_segments(u + pos + k, u + pos + k, v, nv - k);
+            }
+            while (borrow) {
+                qh -= mpt_sub_1_segments(q + pos, q + pos, k, 1);
+                borrow -= mpt_add_n_segments(u + pos, u + pos, v, nv);
+            }
+        }
+    }
+
+    /* Zbylé bloky mají plnou délku a zbytek nad nimi je vždy menší než dělitel */
+    while (pos > 0) {
+        pos -= nv;
+        if (!div_2n_by_n_(q + pos, &qh, u + pos, v, nv, tmp, ctx)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void mpt_set_bz_threshold(const size_t threshold) {
+    bz_threshold_ = threshold < MPT_BZ_THRESHOLD_MIN ? MPT_BZ_THRESHOLD_MIN : threshold;
+}
+
+size_t mpt_get_bz_threshold(void) {
+    return bz_threshold_;
+}
+
+int mpt_divrem_segments(segment_type *q, segment_type *r, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx) {
+    segment_type *u, *v, *tmp, top;
+    unsigned int shift = 0;
+    int res = 1;
+
+    if (!a || !b || nb == 0 || na < nb || b[nb - 1] == 0) {
+        return 0;
+    }
+
+    if (nb == 1) {
+        top = mpt_divrem_1_segments(q, a, na, b[0]);
+        if (r) {
+            r[0] = top;
+        }
+        return 1;
+    }
+
+    /* Normalizace: dělitel se posune tak, aby měl nastavený nejvyšší bit, dělenec o stejný počet bitů */
+    for (top = b[nb - 1]; !(top >> (SEGMENT_BITS - 1)); top <<= 1) {
+        ++shift;
+    }
+
+    /* Normalizovaný dělenec, normalizovaný dělitel, pomocná paměť rekurze a případně podíl, o který volající nestojí */
+    if (!(u = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_div, (na + 1 + 2 * nb + (q ? 0 : na + 1 - nb)) * sizeof(segment_type)))) {
+        return 0;
+    }
+    v = u + na + 1;
+    tmp = v + nb;
+    if (!q) {
+        q = tmp + nb;
+    }
+
+    if (shift) {
+        mpt_lshift_segments(v, b, nb, shift);
+        u[na] = mpt_lshift_segments(u, a, na, shift);
+    } else {
+        memcpy(v, b, nb * sizeof(segment_type));
+        memcpy(u, a, na * sizeof(segment_type));
+        u[na] = 0;
+    }
+
+    /* Rekurzivní dělení se vyplatí, jen když je dlouhý dělitel i podíl */
+    if (nb >= bz_threshold_ && na + 1 - nb >= bz_threshold_) {
+        res = div_dc_(q, u, na + 1, v, nb, tmp, ctx);
+    } else {
+        div_basecase_(q, u, na + 1, v, nb);
+    }
+
+    if (res && r) {
+        if (shift) {
+            mpt_rshift_segments(r, u, nb, shift);
+            r[nb - 1] |= u[nb] << (SEGMENT_BITS - shift);
+        } else {
+            memcpy(r, u, nb * sizeof(segment_type));
+        }
+    }
+
+    mpt_ctx_release(ctx, u);
+    return res;
+}
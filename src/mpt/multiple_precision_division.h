@@ -0,0 +1,67 @@
+/**
+ * @file multiple_precision_division.h
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Hlavičkový soubor s deklaracemi funkcí pro dělení polí segmentů bez znaménka.
+ *        Funkce pracují přímo nad segmenty a slouží jako jádro pro operace mpt_div a mpt_mod.
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#ifndef _MPT_DIVISION_H
+#define _MPT_DIVISION_H
+
+#include "multiple_precision_type.h"
+#include "multiple_precision_context.h"
+
+/**
+ * @brief Výchozí počet segmentů dělitele (a zároveň podílu), od kterého se místo školního dělení použije
+ *        rekurzivní Burnikelovo–Zieglerovo dělení. Lze ho změnit při překladu (-DMPT_BZ_THRESHOLD=...)
+ *        nebo za běhu funkcí mpt_set_bz_threshold.
+ */
+#ifndef MPT_BZ_THRESHOLD
+#define MPT_BZ_THRESHOLD 60
+#endif
+
+/** @brief Nejmenší povolený práh rekurzivního dělení, školní dělení potřebuje dělitele alespoň o dvou segmentech. */
+#define MPT_BZ_THRESHOLD_MIN 4
+
+/**
+ * @brief Nastaví počet segmentů, od kterého se dělí rekurzivním algoritmem.
+ *        Hodnoty menší než MPT_BZ_THRESHOLD_MIN se zaokrouhlí nahoru.
+ * @param threshold Nový práh.
+ */
+void mpt_set_bz_threshold(const size_t threshold);
+
+/**
+ * @brief Vrátí aktuální počet segmentů, od kterého se dělí rekurzivním algoritmem.
+ * @return size_t Aktuální práh.
+ */
+size_t mpt_get_bz_threshold(void);
+
+/**
+ * @brief Vydělí hodnotu bez znaménka zadanou polem segmentů jedním segmentem. Místo dělení segmentů
+ *        používá násobení předpočtenou převrácenou hodnotou dělitele. 'q' se smí shodovat s 'a'.
+ * @param q Ukazatel na segmenty podílu (n), nebo NULL, pokud podíl není potřeba.
+ * @param a Ukazatel na segmenty dělence.
+ * @param n Počet segmentů dělence.
+ * @param d Nenulový dělitel.
+ * @return segment_type Zbytek po dělení (0 i při chybných parametrech).
+ */
+segment_type mpt_divrem_1_segments(segment_type *q, const segment_type *a, const size_t n, const segment_type d);
+
+/**
+ * @brief Vydělí hodnotu bez znaménka 'a' hodnotou bez znaménka 'b' a zapíše podíl do 'q' a zbytek do 'r'.
+ *        Krátké dělitele dělí Knuthovým algoritmem D, dlouhé rekurzivním Burnikelovým–Zieglerovým dělením,
+ *        které využívá rychlé násobení. Pomocnou paměť vezme z kontextu, bez něj ji alokuje jednou na celé volání.
+ * @param q Ukazatel na segmenty podílu (na - nb + 1), nebo NULL, pokud podíl není potřeba.
+ * @param r Ukazatel na segmenty zbytku (nb), nebo NULL, pokud zbytek není potřeba.
+ * @param a Ukazatel na segmenty dělence.
+ * @param na Počet segmentů dělence, alespoň nb.
+ * @param b Ukazatel na segmenty dělitele, nejvyšší segment nesmí být nulový.
+ * @param nb Počet segmentů dělitele.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_divrem_segments(segment_type *q, segment_type *r, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx);
+
+#endif
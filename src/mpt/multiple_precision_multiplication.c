@@ -0,0 +1,877 @@
+#include <stdlib.h>
+#include "multiple_precision_multiplication.h"
+#include "multiple_precision_segments.h"
+
+/** Aktuální práh Karatsubova algoritmu (počet segmentů menšího činitele). */
+static size_t karatsuba_threshold_ = MPT_KARATSUBA_THRESHOLD;
+
+/** Aktuální práh algoritmu Toom-3 (počet segmentů menšího činitele). */
+static size_t toom3_threshold_ = MPT_TOOM3_THRESHOLD;
+
+/** Aktuální práh násobení pomocí NTT (počet segmentů menšího činitele). */
+static size_t fft_threshold_ = MPT_FFT_THRESHOLD;
+
+/**
+ * \brief Do 'res' zapíše absolutní hodnotu rozdílu 'a' (na segmentů) a 'b' (nb segmentů, nb <= na), výsledek má na segmentů.
+ * \return int 1 pokud byl rozdíl a - b záporný, jinak 0.
+ */
+static int abs_diff_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb) {
+    size_t i;
+
+    if (mpt_cmp_segments(a, na, b, nb) >= 0) {
+        mpt_sub_segments(res, a, na, b, nb);
+        return 0;
+    }
+
+    /* a < b, takže horní segmenty 'a' nad nb jsou nulové */
+    mpt_sub_n_segments(res, b, a, nb);
+    for (i = nb; i < na; ++i) {
+        res[i] = 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief Aritmeticky posune hodnotu v doplňkovém kódu o jeden bit doprava (nejvyšší bit se zachová).
+ * \param x Ukazatel na segmenty hodnoty.
+ * \param n Počet segmentů.
+ */
+static void rshift1_(segment_type *x, const size_t n) {
+    size_t i;
+
+    for (i = 0; i + 1 < n; ++i) {
+        x[i] = (x[i] >> 1) | (x[i + 1] << (SEGMENT_BITS - 1));
+    }
+    x[n - 1] = (x[n - 1] >> 1) | (x[n - 1] & ((segment_type)1 << (SEGMENT_BITS - 1)));
+}
+
+/**
+ * \brief Zneguje hodnotu v doplňkovém kódu na místě.
+ * \param x Ukazatel na segmenty hodnoty.
+ * \param n Počet segmentů.
+ */
+static void negate_(segment_type *x, const size_t n) {
+    segment_type borrow = 0, next;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        next = x[i] != 0 || borrow;
+        x[i] = (segment_type)0 - x[i] - borrow;
+        borrow = next;
+    }
+}
+
+/**
+ * \brief Vydělí hodnotu v doplňkovém kódu třemi na místě. Dělení musí vycházet beze zbytku,
+ *        pak stačí násobit inverzí trojky modulo 2^SEGMENT_BITS a odečítat přenosy od nejnižšího segmentu.
+ * \param x Ukazatel na segmenty hodnoty.
+ * \param n Počet segmentů.
+ */
+static void divexact_by3_(segment_type *x, const size_t n) {
+    segment_type inverse, s, borrow = 0;
+    size_t i;
+
+    /* 3 * 0xaa...ab = 2^SEGMENT_BITS + 1 */
+    inverse = (segment_type)~(segment_type)0 / 3 * 2 + 1;
+
+    for (i = 0; i < n; ++i) {
+        s = x[i] - borrow;
+        borrow = x[i] < borrow;
+        x[i] = s * inverse;
+        borrow += (segment_type)(((double_segment_type)x[i] * 3) >> SEGMENT_BITS);
+    }
+}
+
+/**
+ * \brief Školní násobení. Zapíše do 'res' všech na + nb segmentů součinu, 'res' tedy nemusí být vynulované.
+ * \param res Ukazatel na segmenty výsledku.
+ * \param a Ukazatel na segmenty prvního činitele.
+ * \param na Počet segmentů prvního činitele.
+ * \param b Ukazatel na segmenty druhého činitele.
+ * \param nb Počet segmentů druhého činitele.
+ */
+static void mul_basecase_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb) {
+    size_t i;
+
+    res[na] = mpt_mul_1_segments(res, a, na, b[0]);
+    for (i = 1; i < nb; ++i) {
+        res[i + na] = b[i] != 0 ? mpt_addmul_1_segments(res + i, a, na, b[i]) : 0;
+    }
+}
+
+/**
+ * \brief Školní umocnění na druhou. Každý součin a[i] * a[j] pro i < j se spočte jen jednou,
+ *        jejich součet se zdvojnásobí posunem o bit a nakonec se přičtou čtverce a[i]^2 na diagonále.
+ *        Zapíše do 'res' všech 2n segmentů výsledku.
+ * \param res Ukazatel na segmenty výsledku.
+ * \param a Ukazatel na segmenty umocňované hodnoty.
+ * \param n Počet segmentů umocňované hodnoty.
+ */
+static void sqr_basecase_(segment_type *res, const segment_type *a, const size_t n) {
+    double_segment_type t, square;
+    segment_type carry;
+    size_t i;
+
+    /* Řádek i začíná na segmentu 2i + 1, segmenty pod ním a nejvyšší segment se nastaví zvlášť */
+    res[0] = res[2 * n - 1] = 0;
+    if (n > 1) {
+        res[n] = mpt_mul_1_segments(res + 1, a + 1, n - 1, a[0]);
+    }
+    for (i = 1; i + 1 < n; ++i) {
+        res[i + n] = a[i] != 0 ? mpt_addmul_1_segments(res + 2 * i + 1, a + i + 1, n - i - 1, a[i]) : 0;
+    }
+
+    /* Součet mimodiagonálních součinů je menší než a^2 / 2, po zdvojnásobení se do 2n segmentů vejde */
+    mpt_lshift_segments(res, res, 2 * n, 1);
+
+    carry = 0;
+    for (i = 0; i < n; ++i) {
+        square = (double_segment_type)a[i] * a[i];
+        t = (double_segment_type)res[2 * i] + (segment_type)square + carry;
+        res[2 * i] = (segment_type)t;
+        t = (double_segment_type)res[2 * i + 1] + (square >> SEGMENT_BITS) + (t >> SEGMENT_BITS);
+        res[2 * i + 1] = (segment_type)t;
+        carry = (segment_type)(t >> SEGMENT_BITS);
+    }
+}
+
+/**
+ * \brief Vrátí počet segmentů pomocné paměti, kterou potřebuje mul_rec_ pro větší činitel o n segmentech.
+ *        Každá úroveň rekurze spotřebuje nejvýše 4n + 24 segmentů (Karatsuba 3n + 4, Toom-3 12k + 12)
+ *        a další úroveň pracuje s činiteli o nejvýše n / 2 + 1 segmentech.
+ * \param n Počet segmentů většího činitele.
+ * \return size_t Počet segmentů pomocné paměti.
+ */
+static size_t mul_scratch_size_(size_t n) {
+    size_t total = 0;
+
+    while (n >= karatsuba_threshold_) {
+        total += 4 * n + 24;
+        n = (n + 1) / 2 + 1;
+    }
+
+    return total;
+}
+
+static void mul_rec_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, segment_type *scratch);
+
+/**
+ * \brief Vyhodnotí polynom x2 * t^2 + x1 * t + x0 v bodech 1, -1 a -2. Výsledky mají k + 1 segmentů,
+ *        hodnoty v bodech -1 a -2 se zapíší jako absolutní hodnoty.
+ * \param p1 Ukazatel na segmenty hodnoty v bodě 1.
+ * \param pm1 Ukazatel na segmenty absolutní hodnoty v bodě -1.
+ * \param pm2 Ukazatel na segmenty absolutní hodnoty v bodě -2.
+ * \param x Ukazatel na segmenty činitele, x0 a x1 mají k segmentů, x2 zbylých n2 segmentů.
+ * \param k Počet segmentů x0 a x1.
+ * \param n2 Počet segmentů x2.
+ * \return int Bit 0 je nastaven, pokud je hodnota v bodě -1 záporná, bit 1, pokud je záporná hodnota v bodě -2.
+ */
+static int toom3_eval_(segment_type *p1, segment_type *pm1, segment_type *pm2, const segment_type *x, const size_t k, const size_t n2) {
+    int negative = 0;
+
+    /* Hodnoty se počítají v doplňkovém kódu na k + 1 segmentech, |x(-2)| < 5 * B^k se do nich vejde */
+    p1[k] = mpt_add_segments(p1, x, k, x + 2 * k, n2);
+    mpt_sub_segments(pm1, p1, k + 1, x + k, k);
+    mpt_add_segments(p1, p1, k + 1, x + k, k);
+
+    mpt_add_segments(pm2, pm1, k + 1, x + 2 * k, n2);
+    mpt_lshift_segments(pm2, pm2, k + 1, 1);
+    mpt_sub_segments(pm2, pm2, k + 1, x, k);
+
+    if (pm1[k] >> (SEGMENT_BITS - 1)) {
+        negate_(pm1, k + 1);
+        negative |= 1;
+    }
+    if (pm2[k] >> (SEGMENT_BITS - 1)) {
+        negate_(pm2, k + 1);
+        negative |= 2;
+    }
+
+    return negative;
+}
+
+/**
+ * \brief Interpolace algoritmu Toom-3 (Bodrato). Z hodnot součinu v bodech 1, -1 a -2 a z r(0) a r(nekonečno),
+ *        které už leží na svých místech ve výsledku, dopočte prostřední koeficienty a přičte je do výsledku.
+ *        Všechny mezivýsledky se vejdou do 2k + 2 segmentů v doplňkovém kódu.
+ * \param res Ukazatel na segmenty výsledku, r(0) je v segmentech 0 .. 2k - 1, r(nekonečno) od segmentu 4k, segmenty mezi nimi jsou nulové.
+ * \param r1 Ukazatel na 2k + 2 segmentů hodnoty v bodě 1, slouží i jako pomocná paměť.
+ * \param rm1 Ukazatel na 2k + 2 segmentů hodnoty v bodě -1 v doplňkovém kódu, slouží i jako pomocná paměť.
+ * \param rm2 Ukazatel na 2k + 2 segmentů hodnoty v bodě -2 v doplňkovém kódu, slouží i jako pomocná paměť.
+ * \param k Počet segmentů jedné části činitelů.
+ * \param n Počet segmentů výsledku.
+ */
+static void toom3_interpolate_(segment_type *res, segment_type *r1, segment_type *rm1, segment_type *rm2, const size_t k, const size_t n) {
+    const size_t l = 2 * k + 2, n4 = n - 4 * k;
+    segment_type *coefs[3];
+    size_t i, offset, len;
+
+    mpt_sub_n_segments(rm2, rm2, r1, l);
+    divexact_by3_(rm2, l);                          /* rm2 = (r(-2) - r(1)) / 3 */
+    mpt_sub_n_segments(r1, r1, rm1, l);
+    rshift1_(r1, l);                                /* r1 = (r(1) - r(-1)) / 2 */
+    mpt_sub_segments(rm1, rm1, l, res, 2 * k);      /* rm1 = r(-1) - r(0) */
+    mpt_sub_n_segments(rm2, rm1, rm2, l);
+    rshift1_(rm2, l);
+    mpt_add_segments(rm2, rm2, l, res + 4 * k, n4);
+    mpt_add_segments(rm2, rm2, l, res + 4 * k, n4); /* rm2 = (rm1 - rm2) / 2 + 2 * r(nekonečno) */
+    mpt_add_n_segments(rm1, rm1, r1, l);
+    mpt_sub_segments(rm1, rm1, l, res + 4 * k, n4); /* rm1 = rm1 + r1 - r(nekonečno) */
+    mpt_sub_n_segments(r1, r1, rm2, l);             /* r1 = r1 - rm2 */
+
+    coefs[0] = r1;
+    coefs[1] = rm1;
+    coefs[2] = rm2;
+
+    for (i = 0; i < 3; ++i) {
+        /* Koeficienty jsou nezáporné a přesah za konec výsledku tvoří jen nulové segmenty */
+        offset = (i + 1) * k;
+        len = l < n - offset ? l : n - offset;
+        mpt_add_segments(res + offset, res + offset, n - offset, coefs[i], len);
+    }
+}
+
+/**
+ * \brief Násobení algoritmem Toom-3, pro na >= nb > 2k, kde k = ceil(na / 3).
+ *        Činitele se rozdělí na tři části, vyhodnotí v bodech 0, 1, -1, -2 a nekonečnu,
+ *        pět součinů se spočítá rekurzivně a koeficienty výsledku se interpolují v doplňkovém kódu.
+ * \param res Ukazatel na segmenty výsledku (na + nb segmentů).
+ * \param a Ukazatel na segmenty většího činitele.
+ * \param na Počet segmentů většího činitele.
+ * \param b Ukazatel na segmenty menšího činitele.
+ * \param nb Počet segmentů menšího činitele.
+ * \param scratch Pomocná paměť o velikosti alespoň mul_scratch_size_(na).
+ */
+static void mul_toom3_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, segment_type *scratch) {
+    size_t i, k, l;
+    segment_type *p1, *q1, *pm1, *qm1, *pm2, *qm2, *r1, *rm1, *rm2, *rest;
+    int sign_a, sign_b;
+
+    k = (na + 2) / 3;
+    l = 2 * k + 2;
+
+    p1 = scratch;
+    q1 = p1 + k + 1;
+    pm1 = q1 + k + 1;
+    qm1 = pm1 + k + 1;
+    pm2 = qm1 + k + 1;
+    qm2 = pm2 + k + 1;
+    r1 = qm2 + k + 1;
+    rm1 = r1 + l;
+    rm2 = rm1 + l;
+    rest = rm2 + l;
+
+    sign_a = toom3_eval_(p1, pm1, pm2, a, k, na - 2 * k);
+    sign_b = toom3_eval_(q1, qm1, qm2, b, k, nb - 2 * k);
+
+    /* r(0) a r(nekonečno) se zapíší rovnou na své místo ve výsledku */
+    mul_rec_(res, a, k, b, k, rest);
+    mul_rec_(res + 4 * k, a + 2 * k, na - 2 * k, b + 2 * k, nb - 2 * k, rest);
+    for (i = 2 * k; i < 4 * k; ++i) {
+        res[i] = 0;
+    }
+
+    mul_rec_(r1, p1, k + 1, q1, k + 1, rest);
+    mul_rec_(rm1, pm1, k + 1, qm1, k + 1, rest);
+    mul_rec_(rm2, pm2, k + 1, qm2, k + 1, rest);
+    if ((sign_a ^ sign_b) & 1) {
+        negate_(rm1, l);
+    }
+    if ((sign_a ^ sign_b) & 2) {
+        negate_(rm2, l);
+    }
+
+    toom3_interpolate_(res, r1, rm1, rm2, k, na + nb);
+}
+
+/**
+ * \brief Rekurzivní násobení, pro na >= nb. Malé činitele násobí školním algoritmem,
+ *        výrazně nevyvážené činitele násobí po blocích velikosti nb, velké činitele algoritmem Toom-3
+ *        a ostatní Karatsubovým algoritmem.
+ * \param res Ukazatel na segmenty výsledku (na + nb segmentů, nepřekrývá se s činiteli ani s pomocnou pamětí).
+ * \param a Ukazatel na segmenty většího činitele.
+ * \param na Počet segmentů většího činitele.
+ * \param b Ukazatel na segmenty menšího činitele.
+ * \param nb Počet segmentů menšího činitele.
+ * \param scratch Pomocná paměť o velikosti alespoň mul_scratch_size_(na).
+ */
+static void mul_rec_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, segment_type *scratch) {
+    size_t m, k, len, n1a, n1b, mid_len;
+    segment_type *da, *db, *t, *mid, *rest;
+    int negative;
+
+    if (nb < karatsuba_threshold_) {
+        mul_basecase_(res, a, na, b, nb);
+        return;
+    }
+
+    m = (na + 1) / 2;
+
+    if (nb <= m) {
+        /* Nevyvážené činitele: 'a' se násobí po blocích o nb segmentech, součiny se přičítají do výsledku */
+        t = scratch;
+        rest = scratch + 2 * nb;
+
+        mul_rec_(res, a, nb, b, nb, rest);
+
+        for (k = nb; k < na; k += nb) {
+            len = na - k < nb ? na - k : nb;
+            mul_rec_(t, b, nb, a + k, len, rest);
+            mpt_add_1_segments(res + k + nb, t + nb, len, mpt_add_n_segments(res + k, res + k, t, nb));
+        }
+        return;
+    }
+
+    if (nb >= toom3_threshold_ && nb > 2 * ((na + 2) / 3)) {
+        mul_toom3_(res, a, na, b, nb, scratch);
+        return;
+    }
+
+    /* a = a1 * B^m + a0, b = b1 * B^m + b0, a0*b1 + a1*b0 = a0*b0 + a1*b1 - (a0 - a1)(b0 - b1) */
+    n1a = na - m;
+    n1b = nb - m;
+
+    da = scratch;
+    db = da + m;
+    t = db + m;
+    mid = t + 2 * m;
+    rest = mid + 2 * m + 1;
+
+    negative = abs_diff_(da, a, m, a + m, n1a);
+    negative ^= abs_diff_(db, b, m, b + m, n1b);
+
+    mul_rec_(res, a, m, b, m, rest);
+    mul_rec_(res + 2 * m, a + m, n1a, b + m, n1b, rest);
+    mul_rec_(t, da, m, db, m, rest);
+
+    mid[2 * m] = mpt_add_segments(mid, res, 2 * m, res + 2 * m, n1a + n1b);
+
+    if (negative) {
+        mpt_add_segments(mid, mid, 2 * m + 1, t, 2 * m);
+    } else {
+        mpt_sub_segments(mid, mid, 2 * m + 1, t, 2 * m);
+    }
+
+    /* Prostřední člen se vejde do zbytku výsledku, případný přesah tvoří jen nulové segmenty */
+    mid_len = 2 * m + 1;
+    if (mid_len > na + nb - m) {
+        mid_len = na + nb - m;
+    }
+    mpt_add_segments(res + m, res + m, na + nb - m, mid, mid_len);
+}
+
+static void sqr_rec_(segment_type *res, const segment_type *a, const size_t n, segment_type *scratch);
+
+/**
+ * \brief Umocnění na druhou algoritmem Toom-3, pro n > 2k, kde k = ceil(n / 3). Hodnota se vyhodnotí
+ *        v bodech 1, -1 a -2 jen jednou a všech pět součinů jsou druhé mocniny, takže znaménka hodnot
+ *        v záporných bodech nehrají roli.
+ * \param res Ukazatel na segmenty výsledku (2n segmentů).
+ * \param a Ukazatel na segmenty umocňované hodnoty.
+ * \param n Počet segmentů umocňované hodnoty.
+ * \param scratch Pomocná paměť o velikosti alespoň mul_scratch_size_(n).
+ */
+static void sqr_toom3_(segment_type *res, const segment_type *a, const size_t n, segment_type *scratch) {
+    size_t i, k, l;
+    segment_type *p1, *pm1, *pm2, *r1, *rm1, *rm2, *rest;
+
+    k = (n + 2) / 3;
+    l = 2 * k + 2;
+
+    p1 = scratch;
+    pm1 = p1 + k + 1;
+    pm2 = pm1 + k + 1;
+    r1 = pm2 + k + 1;
+    rm1 = r1 + l;
+    rm2 = rm1 + l;
+    rest = rm2 + l;
+
+    toom3_eval_(p1, pm1, pm2, a, k, n - 2 * k);
+
+    sqr_rec_(res, a, k, rest);
+    sqr_rec_(res + 4 * k, a + 2 * k, n - 2 * k, rest);
+    for (i = 2 * k; i < 4 * k; ++i) {
+        res[i] = 0;
+    }
+
+    sqr_rec_(r1, p1, k + 1, rest);
+    sqr_rec_(rm1, pm1, k + 1, rest);
+    sqr_rec_(rm2, pm2, k + 1, rest);
+
+    toom3_interpolate_(res, r1, rm1, rm2, k, 2 * n);
+}
+
+/**
+ * \brief Rekurzivní umocnění na druhou. Malé hodnoty umocní školním algoritmem, velké algoritmem Toom-3
+ *        a ostatní Karatsubovým algoritmem, který místo tří součinů počítá tři druhé mocniny.
+ * \param res Ukazatel na segmenty výsledku (2n segmentů, nepřekrývá se s umocňovanou hodnotou ani s pomocnou pamětí).
+ * \param a Ukazatel na segmenty umocňované hodnoty.
+ * \param n Počet segmentů umocňované hodnoty.
+ * \param scratch Pomocná paměť o velikosti alespoň mul_scratch_size_(n).
+ */
+static void sqr_rec_(segment_type *res, const segment_type *a, const size_t n, segment_type *scratch) {
+    size_t m, n1, mid_len;
+    segment_type *d, *t, *mid, *rest;
+
+    if (n < karatsuba_threshold_) {
+        sqr_basecase_(res, a, n);
+        return;
+    }
+
+    if (n >= toom3_threshold_ && n > 2 * ((n + 2) / 3)) {
+        sqr_toom3_(res, a, n, scratch);
+        return;
+    }
+
+    /* a = a1 * B^m + a0, 2 * a0 * a1 = a0^2 + a1^2 - (a0 - a1)^2 */
+    m = (n + 1) / 2;
+    n1 = n - m;
+
+    d = scratch;
+    t = d + m;
+    mid = t + 2 * m;
+    rest = mid + 2 * m + 1;
+
+    abs_diff_(d, a, m, a + m, n1);
+
+    sqr_rec_(res, a, m, rest);
+    sqr_rec_(res + 2 * m, a + m, n1, rest);
+    sqr_rec_(t, d, m, rest);
+
+    mid[2 * m] = mpt_add_segments(mid, res, 2 * m, res + 2 * m, 2 * n1);
+    mpt_sub_segments(mid, mid, 2 * m + 1, t, 2 * m);
+
+    mid_len = 2 * m + 1;
+    if (mid_len > 2 * n - m) {
+        mid_len = 2 * n - m;
+    }
+    mpt_add_segments(res + m, res + m, 2 * n - m, mid, mid_len);
+}
+
+/*
+ * Násobení číselně teoretickou transformací (NTT). Činitele se rozloží na 32bitové číslice,
+ * jejich konvoluce se spočte zvlášť modulo tří prvočísel menších než 2^31 a každý koeficient
+ * se složí z těchto zbytků čínskou větou o zbytcích (Garnerovým algoritmem). Součin prvočísel
+ * je přibližně 2^89, koeficienty konvoluce proto zůstanou přesné až do délky transformace 2^24.
+ * Násobení modulo prvočíslo probíhá Montgomeryho redukcí, kořeny jednotky jsou uložené
+ * v Montgomeryho tvaru, data transformace zůstávají v běžném tvaru.
+ */
+
+#if UINT_MAX != 0xffffffffUL
+#error "NTT násobení předpokládá 32bitový typ unsigned int."
+#endif
+
+/** @brief Číslice činitelů a zbytky modulo prvočísla transformace (32 bitů). */
+typedef unsigned int ntt_type;
+
+/** @brief Typ, do kterého se vejde součin dvou hodnot ntt_type. */
+#if ULONG_MAX > 0xffffffffUL
+typedef unsigned long ntt_wide_type;
+#else
+__extension__ typedef unsigned long long ntt_wide_type;
+#endif
+
+/** Počet bitů jedné číslice transformace. */
+#define NTT_DIGIT_BITS 32
+
+/** Počet číslic transformace v jednom segmentu. */
+#define NTT_DIGITS_PER_SEGMENT (SEGMENT_BITS / NTT_DIGIT_BITS)
+
+/** Dvojkový logaritmus největší délky transformace, kterou podporují všechna tři prvočísla. */
+#define NTT_MAX_LOG 24
+
+/** Počet prvočísel transformace. */
+#define NTT_PRIMES 3
+
+/** Prvočísla transformace (c * 2^k + 1) a jejich primitivní kořeny. */
+static const ntt_type ntt_primes_[NTT_PRIMES][2] = {
+    { 2013265921u, 31 },    /* 15 * 2^27 + 1 */
+    { 469762049u, 3 },      /* 7 * 2^26 + 1 */
+    { 754974721u, 11 }      /* 45 * 2^24 + 1 */
+};
+
+/**
+ * \brief Spočte -p^-1 modulo 2^32 pro Montgomeryho redukci.
+ * \param p Liché prvočíslo.
+ * \return ntt_type Záporná inverze prvočísla.
+ */
+static ntt_type ntt_mont_inverse_(const ntt_type p) {
+    ntt_type inv = p;
+    int i;
+
+    /* Každý Newtonův krok zdvojnásobí počet platných bitů, p * p = 1 (mod 8) platí pro 3 bity */
+    for (i = 0; i < 4; ++i) {
+        inv *= 2 - p * inv;
+    }
+
+    return 0 - inv;
+}
+
+/**
+ * \brief Montgomeryho součin a * b * 2^-32 modulo p.
+ * \param a První činitel menší než p.
+ * \param b Druhý činitel menší než p.
+ * \param p Prvočíslo menší než 2^31.
+ * \param inv Hodnota -p^-1 modulo 2^32.
+ * \return ntt_type Výsledek menší než p.
+ */
+static ntt_type ntt_mont_mul_(const ntt_type a, const ntt_type b, const ntt_type p, const ntt_type inv) {
+    ntt_wide_type t = (ntt_wide_type)a * b;
+    ntt_type m = (ntt_type)t * inv;
+    ntt_type u = (ntt_type)((t + (ntt_wide_type)m * p) >> NTT_DIGIT_BITS);
+
+    return u >= p ? u - p : u;
+}
+
+/**
+ * \brief Převede hodnotu do Montgomeryho tvaru (x * 2^32 modulo p).
+ */
+static ntt_type ntt_to_mont_(const ntt_type x, const ntt_type p) {
+    return (ntt_type)(((ntt_wide_type)x << NTT_DIGIT_BITS) % p);
+}
+
+/**
+ * \brief Spočte base^exp modulo p (hodnoty v běžném tvaru, používá se jen při přípravě transformace).
+ */
+static ntt_type ntt_pow_(const ntt_type base, size_t exp, const ntt_type p) {
+    ntt_wide_type res = 1, b = base % p;
+
+    for (; exp; exp >>= 1) {
+        if (exp & 1) {
+            res = res * b % p;
+        }
+        b = b * b % p;
+    }
+
+    return (ntt_type)res;
+}
+
+/**
+ * \brief Sečte dva zbytky modulo p.
+ */
+static ntt_type ntt_add_(const ntt_type a, const ntt_type b, const ntt_type p) {
+    ntt_type sum = a + b;
+    return sum >= p ? sum - p : sum;
+}
+
+/**
+ * \brief Odečte dva zbytky modulo p.
+ */
+static ntt_type ntt_sub_(const ntt_type a, const ntt_type b, const ntt_type p) {
+    return a >= b ? a - b : a + (p - b);
+}
+
+/**
+ * \brief Vrátí i-tou 32bitovou číslici pole segmentů.
+ */
+static ntt_type ntt_digit_(const segment_type *x, const size_t i) {
+    return (ntt_type)(x[i / NTT_DIGITS_PER_SEGMENT] >> (NTT_DIGIT_BITS * (i % NTT_DIGITS_PER_SEGMENT)));
+}
+
+/**
+ * \brief Načte číslice činitele modulo p do pole transformace a doplní ho nulami.
+ * \param x Pole transformace o n prvcích.
+ * \param n Délka transformace.
+ * \param a Ukazatel na segmenty činitele.
+ * \param digits Počet číslic činitele (nejvýše n).
+ * \param p Prvočíslo transformace.
+ */
+static void ntt_load_(ntt_type *x, const size_t n, const segment_type *a, const size_t digits, const ntt_type p) {
+    size_t i;
+
+    for (i = 0; i < digits; ++i) {
+        x[i] = ntt_digit_(a, i) % p;
+    }
+    for (; i < n; ++i) {
+        x[i] = 0;
+    }
+}
+
+/**
+ * \brief Dopředná transformace s decimací ve frekvenci. Vstup je v přirozeném pořadí, výstup v bitově obráceném.
+ * \param x Pole transformace o n prvcích.
+ * \param n Délka transformace (mocnina dvou).
+ * \param w Mocniny primitivní n-té odmocniny z jedné w^0 .. w^(n/2 - 1) v Montgomeryho tvaru.
+ * \param p Prvočíslo transformace.
+ * \param inv Hodnota -p^-1 modulo 2^32.
+ */
+static void ntt_forward_(ntt_type *x, const size_t n, const ntt_type *w, const ntt_type p, const ntt_type inv) {
+    size_t len, half, stride, i, j;
+    ntt_type u, v;
+
+    for (len = n, stride = 1; len >= 2; len >>= 1, stride <<= 1) {
+        half = len / 2;
+        for (i = 0; i < n; i += len) {
+            for (j = 0; j < half; ++j) {
+                u = x[i + j];
+                v = x[i + j + half];
+                x[i + j] = ntt_add_(u, v, p);
+                x[i + j + half] = ntt_mont_mul_(ntt_sub_(u, v, p), w[j * stride], p, inv);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Zpětná transformace s decimací v čase (bez dělení délkou). Vstup je v bitově obráceném pořadí, výstup v přirozeném.
+ *        Záporné mocniny kořene se berou z tabulky dopředné transformace: w^-j = -w^(len/2 - j).
+ * \param x Pole transformace o n prvcích.
+ * \param n Délka transformace (mocnina dvou).
+ * \param w Mocniny primitivní n-té odmocniny z jedné w^0 .. w^(n/2 - 1) v Montgomeryho tvaru.
+ * \param p Prvočíslo transformace.
+ * \param inv Hodnota -p^-1 modulo 2^32.
+ */
+static void ntt_inverse_(ntt_type *x, const size_t n, const ntt_type *w, const ntt_type p, const ntt_type inv) {
+    size_t len, half, stride, i, j;
+    ntt_type u, v;
+
+    for (len = 2, stride = n / 2; len <= n; len <<= 1, stride >>= 1) {
+        half = len / 2;
+        for (i = 0; i < n; i += len) {
+            u = x[i];
+            v = x[i + half];
+            x[i] = ntt_add_(u, v, p);
+            x[i + half] = ntt_sub_(u, v, p);
+            for (j = 1; j < half; ++j) {
+                u = x[i + j];
+                v = ntt_mont_mul_(x[i + j + half], p - w[(half - j) * stride], p, inv);
+                x[i + j] = ntt_add_(u, v, p);
+                x[i + j + half] = ntt_sub_(u, v, p);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Spočte cyklickou konvoluci číslic obou činitelů modulo jedno prvočíslo.
+ *        Při umocnění na druhou stačí jedna dopředná transformace a pomocné pole se nepoužije.
+ * \param x Pole transformace o n prvcích, do kterého se zapíše výsledek.
+ * \param tmp Pomocné pole o n prvcích (při umocnění na druhou může být NULL).
+ * \param w Pomocné pole o n / 2 prvcích pro mocniny kořene.
+ * \param n Délka transformace (mocnina dvou, nejvýše 2^NTT_MAX_LOG).
+ * \param a Ukazatel na segmenty prvního činitele.
+ * \param nda Počet číslic prvního činitele.
+ * \param b Ukazatel na segmenty druhého činitele, NULL pro umocnění prvního činitele na druhou.
+ * \param ndb Počet číslic druhého činitele.
+ * \param prime Index prvočísla v ntt_primes_.
+ */
+static void ntt_convolve_(ntt_type *x, ntt_type *tmp, ntt_type *w, const size_t n,
+                          const segment_type *a, const size_t nda, const segment_type *b, const size_t ndb, const size_t prime) {
+    const ntt_type p = ntt_primes_[prime][0], inv = ntt_mont_inverse_(p);
+    ntt_type root, scale;
+    size_t i;
+
+    root = ntt_to_mont_(ntt_pow_(ntt_primes_[prime][1], (p - 1) / n, p), p);
+    if (n > 1) {
+        w[0] = ntt_to_mont_(1, p);
+    }
+    for (i = 1; i < n / 2; ++i) {
+        w[i] = ntt_mont_mul_(w[i - 1], root, p, inv);
+    }
+
+    ntt_load_(x, n, a, nda, p);
+    ntt_forward_(x, n, w, p, inv);
+
+    /* Bodový součin v Montgomeryho tvaru ubere faktor 2^32, vrátí ho až závěrečné škálování spolu s dělením délkou */
+    if (b) {
+        ntt_load_(tmp, n, b, ndb, p);
+        ntt_forward_(tmp, n, w, p, inv);
+        for (i = 0; i < n; ++i) {
+            x[i] = ntt_mont_mul_(x[i], tmp[i], p, inv);
+        }
+    } else {
+        for (i = 0; i < n; ++i) {
+            x[i] = ntt_mont_mul_(x[i], x[i], p, inv);
+        }
+    }
+
+    ntt_inverse_(x, n, w, p, inv);
+
+    scale = ntt_to_mont_(ntt_to_mont_(ntt_pow_((ntt_type)(n % p), p - 2, p), p), p);
+    for (i = 0; i < n; ++i) {
+        x[i] = ntt_mont_mul_(x[i], scale, p, inv);
+    }
+}
+
+/**
+ * \brief Složí koeficienty konvoluce ze zbytků modulo tři prvočísla a s přenosy je zapíše jako segmenty výsledku.
+ * \param res Ukazatel na segmenty výsledku.
+ * \param nres Počet segmentů výsledku.
+ * \param r Zbytky koeficientů modulo jednotlivá prvočísla.
+ * \param coefficients Počet koeficientů konvoluce.
+ */
+static void ntt_compose_(segment_type *res, const size_t nres, ntt_type *r[NTT_PRIMES], const size_t coefficients) {
+    const ntt_type p1 = ntt_primes_[0][0], p2 = ntt_primes_[1][0], p3 = ntt_primes_[2][0];
+    const ntt_type inv2 = ntt_mont_inverse_(p2), inv3 = ntt_mont_inverse_(p3);
+    const ntt_wide_type p12 = (ntt_wide_type)p1 * p2;
+    ntt_type c12, c13, c23, x1, x2, x3, digit, carry[3] = { 0, 0, 0 };
+    ntt_wide_type m1, m2, m3, t;
+    size_t i, digits = nres * NTT_DIGITS_PER_SEGMENT;
+
+    /* Inverze p1 modulo p2, p1 modulo p3 a p2 modulo p3 v Montgomeryho tvaru */
+    c12 = ntt_to_mont_(ntt_pow_(p1 % p2, p2 - 2, p2), p2);
+    c13 = ntt_to_mont_(ntt_pow_(p1 % p3, p3 - 2, p3), p3);
+    c23 = ntt_to_mont_(ntt_pow_(p2 % p3, p3 - 2, p3), p3);
+
+    for (i = 0; i < digits; ++i) {
+        x1 = x2 = x3 = 0;
+
+        /* Koeficient = x1 + x2 * p1 + x3 * p1 * p2, kde x1 < p1, x2 < p2 a x3 < p3 */
+        if (i < coefficients) {
+            x1 = r[0][i];
+            x2 = ntt_mont_mul_(ntt_sub_(r[1][i], x1 % p2, p2), c12, p2, inv2);
+            x3 = ntt_mont_mul_(ntt_sub_(r[2][i], x1 % p3, p3), c13, p3, inv3);
+            x3 = ntt_mont_mul_(ntt_sub_(x3, x2 % p3, p3), c23, p3, inv3);
+        }
+
+        /* Přičtení k 96bitovému přenosu po 32bitových slovech, nejnižší slovo je výsledná číslice */
+        m1 = (ntt_wide_type)x2 * p1;
+        m2 = (ntt_wide_type)x3 * (ntt_type)p12;
+        m3 = (ntt_wide_type)x3 * (ntt_type)(p12 >> NTT_DIGIT_BITS);
+
+        t = (ntt_wide_type)carry[0] + x1 + (ntt_type)m1 + (ntt_type)m2;
+        digit = (ntt_type)t;
+        t = (t >> NTT_DIGIT_BITS) + carry[1] + (m1 >> NTT_DIGIT_BITS) + (m2 >> NTT_DIGIT_BITS) + (ntt_type)m3;
+        carry[0] = (ntt_type)t;
+        t = (t >> NTT_DIGIT_BITS) + carry[2] + (m3 >> NTT_DIGIT_BITS);
+        carry[1] = (ntt_type)t;
+        carry[2] = (ntt_type)(t >> NTT_DIGIT_BITS);
+
+        if (i % NTT_DIGITS_PER_SEGMENT == 0) {
+            res[i / NTT_DIGITS_PER_SEGMENT] = 0;
+        }
+        res[i / NTT_DIGITS_PER_SEGMENT] |= (segment_type)digit << (NTT_DIGIT_BITS * (i % NTT_DIGITS_PER_SEGMENT));
+    }
+}
+
+/**
+ * \brief Zjistí, zda se součin činitelů daných velikostí vejde do největší podporované transformace.
+ * \return int 1 pokud ano, 0 pokud ne.
+ */
+static int fft_fits_(const size_t na, const size_t nb) {
+    return (na + nb) * NTT_DIGITS_PER_SEGMENT - 1 <= ((size_t)1 << NTT_MAX_LOG);
+}
+
+/**
+ * \brief Vynásobí dvě hodnoty bez znaménka pomocí NTT. Velikosti činitelů musí splňovat fft_fits_.
+ *        Je-li 'b' NULL, umocní 'a' (na = nb segmentů) na druhou a ušetří tím třetinu transformací.
+ * \param res Ukazatel na segmenty výsledku (na + nb), nesmí se překrývat s činiteli.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * \return int 1 pokud se operace podařila, 0 pokud se nepodařilo alokovat pomocnou paměť.
+ */
+static int mul_fft_(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx) {
+    const size_t nda = na * NTT_DIGITS_PER_SEGMENT, ndb = nb * NTT_DIGITS_PER_SEGMENT;
+    ntt_type *buffer, *r[NTT_PRIMES];
+    size_t i, n = 1;
+
+    while (n < nda + ndb - 1) {
+        n <<= 1;
+    }
+
+    /* Tabulka mocnin kořene, zbytky pro každé prvočíslo a pomocné pole pro druhý činitel (při umocnění na druhou se nealokuje) */
+    if (!(buffer = (ntt_type *)mpt_ctx_acquire(ctx, mpt_slot_fft, (n / 2 + (b ? NTT_PRIMES + 1 : NTT_PRIMES) * n) * sizeof(ntt_type)))) {
+        return 0;
+    }
+
+    for (i = 0; i < NTT_PRIMES; ++i) {
+        r[i] = buffer + n / 2 + i * n;
+        ntt_convolve_(r[i], b ? buffer + n / 2 + NTT_PRIMES * n : NULL, buffer, n, a, nda, b, ndb, i);
+    }
+
+    ntt_compose_(res, na + nb, r, nda + ndb - 1);
+
+    mpt_ctx_release(ctx, buffer);
+    return 1;
+}
+
+void mpt_set_karatsuba_threshold(const size_t threshold) {
+    karatsuba_threshold_ = threshold < MPT_KARATSUBA_THRESHOLD_MIN ? MPT_KARATSUBA_THRESHOLD_MIN : threshold;
+}
+
+size_t mpt_get_karatsuba_threshold(void) {
+    return karatsuba_threshold_;
+}
+
+void mpt_set_toom3_threshold(const size_t threshold) {
+    toom3_threshold_ = threshold < MPT_TOOM3_THRESHOLD_MIN ? MPT_TOOM3_THRESHOLD_MIN : threshold;
+}
+
+size_t mpt_get_toom3_threshold(void) {
+    return toom3_threshold_;
+}
+
+void mpt_set_fft_threshold(const size_t threshold) {
+    fft_threshold_ = threshold < MPT_FFT_THRESHOLD_MIN ? MPT_FFT_THRESHOLD_MIN : threshold;
+}
+
+size_t mpt_get_fft_threshold(void) {
+    return fft_threshold_;
+}
+
+int mpt_mul_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx) {
+    segment_type *scratch;
+
+    if (!res || !a || !b || na == 0 || nb == 0) {
+        return 0;
+    }
+
+    if (na < nb) {
+        return mpt_mul_segments(res, b, nb, a, na, ctx);
+    }
+
+    if (nb < karatsuba_threshold_) {
+        mul_basecase_(res, a, na, b, nb);
+        return 1;
+    }
+
+    if (nb >= fft_threshold_ && fft_fits_(na, nb)) {
+        return mul_fft_(res, a, na, b, nb, ctx);
+    }
+
+    if (!(scratch = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_mul, mul_scratch_size_(na) * sizeof(segment_type)))) {
+        return 0;
+    }
+
+    mul_rec_(res, a, na, b, nb, scratch);
+
+    mpt_ctx_release(ctx, scratch);
+    return 1;
+}
+
+int mpt_mul_segments_fft(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx) {
+    if (!res || !a || !b || na == 0 || nb == 0) {
+        return 0;
+    }
+
+    if (!fft_fits_(na, nb)) {
+        return mpt_mul_segments(res, a, na, b, nb, ctx);
+    }
+
+    return mul_fft_(res, a, na, b, nb, ctx);
+}
+
+int mpt_sqr_segments(segment_type *res, const segment_type *a, const size_t n, mpt_ctx *ctx) {
+    segment_type *scratch;
+
+    if (!res || !a || n == 0) {
+        return 0;
+    }
+
+    if (n < karatsuba_threshold_) {
+        sqr_basecase_(res, a, n);
+        return 1;
+    }
+
+    if (n >= fft_threshold_ && fft_fits_(n, n)) {
+        return mul_fft_(res, a, n, NULL, n, ctx);
+    }
+
+    if (!(scratch = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_mul, mul_scratch_size_(n) * sizeof(segment_type)))) {
+        return 0;
+    }
+
+    sqr_rec_(res, a, n, scratch);
+
+    mpt_ctx_release(ctx, scratch);
+    return 1;
+}
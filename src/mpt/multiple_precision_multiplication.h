@@ -0,0 +1,139 @@
+/**
+ * @file multiple_precision_multiplication.h
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Hlavičkový soubor s deklaracemi funkcí pro násobení polí segmentů bez znaménka.
+ *        Funkce pracují přímo nad segmenty a slouží jako jádro pro operace mpt_mul a mpt_sqr.
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#ifndef _MPT_MULTIPLICATION_H
+#define _MPT_MULTIPLICATION_H
+
+#include "multiple_precision_type.h"
+#include "multiple_precision_context.h"
+
+/**
+ * @brief Výchozí počet segmentů menšího činitele, od kterého se místo školního násobení použije Karatsubův algoritmus.
+ *        Lze ho změnit při překladu (-DMPT_KARATSUBA_THRESHOLD=...) nebo za běhu funkcí mpt_set_karatsuba_threshold.
+ *        Školní násobení 64bitových segmentů je vůči počtu segmentů dražší, Karatsubův algoritmus se proto vyplatí dřív.
+ */
+#ifndef MPT_KARATSUBA_THRESHOLD
+#if MPT_SEGMENT_BITS == 64
+#define MPT_KARATSUBA_THRESHOLD 24
+#else
+#define MPT_KARATSUBA_THRESHOLD 32
+#endif
+#endif
+
+/** @brief Nejmenší povolený práh Karatsubova algoritmu, pod ním by se rekurze nezkracovala. */
+#define MPT_KARATSUBA_THRESHOLD_MIN 4
+
+/**
+ * @brief Výchozí počet segmentů menšího činitele, od kterého se místo Karatsubova algoritmu použije algoritmus Toom-3.
+ *        Lze ho změnit při překladu (-DMPT_TOOM3_THRESHOLD=...) nebo za běhu funkcí mpt_set_toom3_threshold.
+ */
+#ifndef MPT_TOOM3_THRESHOLD
+#define MPT_TOOM3_THRESHOLD 120
+#endif
+
+/** @brief Nejmenší povolený práh algoritmu Toom-3. */
+#define MPT_TOOM3_THRESHOLD_MIN 6
+
+/**
+ * @brief Výchozí počet segmentů menšího činitele, od kterého se místo algoritmu Toom-3 násobí pomocí NTT.
+ *        Lze ho změnit při překladu (-DMPT_FFT_THRESHOLD=...) nebo za běhu funkcí mpt_set_fft_threshold.
+ *        NTT pracuje s 32bitovými číslicemi, 64bitový segment dává dvě číslice a délka transformace se tak zdvojnásobí.
+ */
+#ifndef MPT_FFT_THRESHOLD
+#if MPT_SEGMENT_BITS == 64
+#define MPT_FFT_THRESHOLD 7000
+#else
+#define MPT_FFT_THRESHOLD 3000
+#endif
+#endif
+
+/** @brief Nejmenší povolený práh násobení pomocí NTT. */
+#define MPT_FFT_THRESHOLD_MIN 16
+
+/**
+ * @brief Nastaví počet segmentů, od kterého se násobí Karatsubovým algoritmem.
+ *        Hodnoty menší než MPT_KARATSUBA_THRESHOLD_MIN se zaokrouhlí nahoru.
+ * @param threshold Nový práh.
+ */
+void mpt_set_karatsuba_threshold(const size_t threshold);
+
+/**
+ * @brief Vrátí aktuální počet segmentů, od kterého se násobí Karatsubovým algoritmem.
+ * @return size_t Aktuální práh.
+ */
+size_t mpt_get_karatsuba_threshold(void);
+
+/**
+ * @brief Nastaví počet segmentů, od kterého se násobí algoritmem Toom-3.
+ *        Hodnoty menší než MPT_TOOM3_THRESHOLD_MIN se zaokrouhlí nahoru.
+ * @param threshold Nový práh.
+ */
+void mpt_set_toom3_threshold(const size_t threshold);
+
+/**
+ * @brief Vrátí aktuální počet segmentů, od kterého se násobí algoritmem Toom-3.
+ * @return size_t Aktuální práh.
+ */
+size_t mpt_get_toom3_threshold(void);
+
+/**
+ * @brief Nastaví počet segmentů, od kterého se násobí pomocí NTT.
+ *        Hodnoty menší než MPT_FFT_THRESHOLD_MIN se zaokrouhlí nahoru.
+ * @param threshold Nový práh.
+ */
+void mpt_set_fft_threshold(const size_t threshold);
+
+/**
+ * @brief Vrátí aktuální počet segmentů, od kterého se násobí pomocí NTT.
+ * @return size_t Aktuální práh.
+ */
+size_t mpt_get_fft_threshold(void);
+
+/**
+ * @brief Vynásobí dvě hodnoty bez znaménka zadané poli segmentů a výsledek zapíše do 'res'.
+ *        Podle velikosti činitelů zvolí školní násobení, Karatsubův algoritmus, algoritmus Toom-3 nebo NTT.
+ *        Pomocnou paměť pro rekurzi vezme z kontextu, bez něj ji alokuje jednou na celé volání.
+ * @param res Ukazatel na segmenty výsledku, musí jich být alespoň na + nb a nesmí se překrývat s činiteli.
+ * @param a Ukazatel na segmenty prvního činitele.
+ * @param na Počet segmentů prvního činitele.
+ * @param b Ukazatel na segmenty druhého činitele.
+ * @param nb Počet segmentů druhého činitele.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_mul_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx);
+
+/**
+ * @brief Vynásobí dvě hodnoty bez znaménka pomocí číselně teoretické transformace nad třemi prvočísly
+ *        bez ohledu na nastavený práh. Činitele, jejichž součin má více než 2^24 32bitových číslic,
+ *        se násobí funkcí mpt_mul_segments.
+ * @param res Ukazatel na segmenty výsledku, musí jich být alespoň na + nb a nesmí se překrývat s činiteli.
+ * @param a Ukazatel na segmenty prvního činitele.
+ * @param na Počet segmentů prvního činitele.
+ * @param b Ukazatel na segmenty druhého činitele.
+ * @param nb Počet segmentů druhého činitele.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_mul_segments_fft(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb, mpt_ctx *ctx);
+
+/**
+ * @brief Umocní hodnotu bez znaménka zadanou polem segmentů na druhou a výsledek zapíše do 'res'.
+ *        Používá stejné prahy jako mpt_mul_segments, na každé úrovni ale počítá jen druhé mocniny:
+ *        školní algoritmus spočte každý mimodiagonální součin jednou, Karatsubův algoritmus a Toom-3
+ *        vyhodnotí hodnotu jen jednou a NTT potřebuje jen jednu dopřednou transformaci.
+ * @param res Ukazatel na segmenty výsledku, musí jich být alespoň 2n a nesmí se překrývat s 'a'.
+ * @param a Ukazatel na segmenty umocňované hodnoty.
+ * @param n Počet segmentů umocňované hodnoty.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_sqr_segments(segment_type *res, const segment_type *a, const size_t n, mpt_ctx *ctx);
+
+#endif
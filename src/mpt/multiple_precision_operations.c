@@ -1,88 +1,151 @@
-#include <limits.h>
+#include <string.h>
 #include "multiple_precision_operations.h"
+#include "multiple_precision_multiplication.h"
+#include "multiple_precision_division.h"
+#include "multiple_precision_segments.h"
 
-/**
- * \brief Zjistí, jestli má být příznak carry nastaven, když sečteme a, b a předchozí carry.
- * \param a První hodnota pro sečtení.
- * \param b Druhá hodnota pro sečtení.
- * \param carry Předchozí carry.
- * \return uint 1 jestli má být příznak carry nastaven, 0 pokud ne.
- */
-static segment_type addition_carry_(const segment_type a, const segment_type b, const segment_type carry) {
-    segment_type c = a + b;
-    return (c < a) || (c == UINT_MAX && carry == 1);
-}
+/** @brief Definice ukazatele na funkci, která násobí dvě pole segmentů bez znaménka. */
+typedef int (*segments_multiplier)(segment_type *, const segment_type *, const size_t, const segment_type *, const size_t, mpt_ctx *);
+
+/** Největší šířka okna při umocňování, tabulka lichých mocnin základu má 2^(MAX_POW_WINDOW - 1) prvků. */
+#define MAX_POW_WINDOW 6
 
 /**
- * \brief Najde 'most significant set bit (mssb)', tedy pozici nastaveného bitu s nejvyšší vahou. Používá se při výpočtu umocnění.
- * \param value Ukazatel na instanci mpt.
- * \return size_t Index nastaveného bitu s nejvyšší vahou. Vrátí 0 pokud value ukazuje na NULL, nebo je hodnota value rovna nule.
+ * \brief Normalizuje výsledek operace a nastaví mu znaménko. Při neúspěchu instanci deinicializuje.
+ * \param dest Ukazatel na instanci mpt s nenormalizovanou absolutní hodnotou výsledku.
+ * \param negative 1 pokud má být výsledek záporný (nula zůstane kladná).
+ * \return int 1 pokud se normalizace podařila, 0 pokud ne.
  */
-static size_t mpt_get_mssb_pos_(const mpt value) {
-    size_t i, bit_pos, bit_count;
+static int mpt_finish_(mpt *dest, const int negative) {
+    dest->negative = negative;
 
-    if (mpt_is_zero(value)) {
+    if (!mpt_optimize(dest)) {
+        mpt_deinit(dest);
         return 0;
     }
 
-    bit_count = mpt_bit_count(value);
+    return 1;
+}
 
-    for (i = 0; i < bit_count; ++i) {
-        bit_pos = bit_count - i - 1;
-        if (mpt_get_bit(value, bit_pos)) {
-            return bit_pos;
-        }
+/**
+ * \brief Zjistí, zda výsledná instance drží na haldě tytéž segmenty jako operand předaný hodnotou
+ *        (např. mpt_add(&x, x, y), nebo výsledek je klonem operandu). Zápis do výsledku by takový operand přepsal.
+ * \param dest Ukazatel na výslednou instanci mpt.
+ * \param value Instance mpt s operandem.
+ * \return int 1 pokud instance sdílí segmenty, jinak 0.
+ */
+static int mpt_shares_segments_(const mpt *dest, const mpt value) {
+    return dest->size && dest->capacity && value.capacity && dest->limbs == value.limbs;
+}
+
+/**
+ * \brief Připraví výslednou instanci na zápis zadaného počtu segmentů a znovu přitom využije její paměť.
+ *        Sdílí-li výsledek segmenty s operandem, zachovají se a operace je přepíše na místě, jinak se vynulují.
+ *        Zvětšení paměti může segmenty přesunout, ukazatel na ně je proto nutné získat až po přípravě.
+ * \param dest Ukazatel na prázdnou nebo inicializovanou výslednou instanci mpt.
+ * \param segments Počet segmentů výsledku.
+ * \param shared 1 pokud výsledek sdílí segmenty s operandem (viz mpt_shares_segments_), jinak 0.
+ * \return int 1 pokud se příprava podařila, 0 pokud ne (instance pak zůstane prázdná).
+ */
+static int mpt_prepare_(mpt *dest, const size_t segments, const int shared) {
+    if (shared ? mpt_resize(dest, segments) : mpt_init_segments(dest, segments)) {
+        return 1;
     }
 
-    return ~0;
+    mpt_deinit(dest);
+    return 0;
 }
 
-int mpt_compare(const mpt a, const mpt b) {
-    size_t bits_a, bits_b, i;
-    int bit_a, bit_b;
+/**
+ * \brief Zapíše do výsledné instance absolutní hodnotu zadanou polem segmentů a nastaví jí znaménko.
+ *        Slouží operacím, které výsledek spočtou do pomocné paměti, protože výsledek sdílí segmenty s operandem.
+ * \param dest Ukazatel na prázdnou nebo inicializovanou výslednou instanci mpt.
+ * \param segments Ukazatel na segmenty absolutní hodnoty výsledku.
+ * \param count Počet segmentů.
+ * \param negative 1 pokud má být výsledek záporný (nula zůstane kladná).
+ * \return int 1 pokud se zápis podařil, 0 pokud ne (instance pak zůstane prázdná).
+ */
+static int mpt_store_(mpt *dest, const segment_type *segments, const size_t count, const int negative) {
+    if (!mpt_prepare_(dest, count, 0)) {
+        return 0;
+    }
+    memcpy(MPT_SEGMENTS(*dest), segments, count * sizeof(segment_type));
 
-    #define RETURN_IF(v, e) \
-        if (v) { \
-            return e; \
-        }
+    return mpt_finish_(dest, negative);
+}
 
-    RETURN_IF(a.list == b.list, 0);
+/**
+ * \brief Společná část sčítání a odčítání. Stejná znaménka se sečtou jako absolutní hodnoty, různá znaménka
+ *        se odečtou (menší absolutní hodnota od větší) a výsledek převezme znaménko větší z nich.
+ * \param dest Ukazatel na výslednou instanci mpt.
+ * \param a Instance mpt s prvním operandem.
+ * \param b Instance mpt s druhým operandem.
+ * \param subtract 0 pokud se má sčítat, jinak se odčítá.
+ * \return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+static int mpt_add_sub_(mpt *dest, const mpt a, const mpt b, const int subtract) {
+    const size_t na = mpt_segment_count(a), nb = mpt_segment_count(b);
+    const int negative_b = mpt_is_negative(b) != (subtract != 0);
+    const int same_sign = mpt_is_negative(a) == negative_b;
+    const segment_type *seg_a = MPT_SEGMENTS(a), *seg_b = MPT_SEGMENTS(b);
+    int shared_a, shared_b, cmp = 0;
+    segment_type *res;
 
-    RETURN_IF(mpt_is_zero(a) && mpt_is_zero(b), 0);
-    RETURN_IF(mpt_signum(a) > mpt_signum(b), 1);
-    RETURN_IF(mpt_signum(a) < mpt_signum(b), -1);
-    
-    bits_a = mpt_bit_count(a);
-    bits_b = mpt_bit_count(b);
+    if (!dest) {
+        return 0;
+    }
+    shared_a = mpt_shares_segments_(dest, a);
+    shared_b = mpt_shares_segments_(dest, b);
 
-    if (mpt_is_negative(a)) { /* a i b jsou záporná */
-        if (bits_a > bits_b) {
-            return -1;
-        }
-        if (bits_a < bits_b) {
-            return 1;
-        }
+    /* Součet absolutních hodnot má nejvýše o jeden segment víc než delší z nich, rozdíl se vejde do delší z nich */
+    if (!same_sign) {
+        cmp = mpt_cmp_segments(seg_a, na, seg_b, nb);
     }
-    else { /* a i b jsou kladná */
-        if (bits_a > bits_b) {
-            return 1;
-        }
-        if (bits_a < bits_b) {
-            return -1;
+    if (!mpt_prepare_(dest, (na >= nb ? na : nb) + (same_sign ? 1 : 0), shared_a || shared_b)) {
+        return 0;
+    }
+    res = MPT_SEGMENTS(*dest);
+    if (shared_a) {
+        seg_a = res;
+    }
+    if (shared_b) {
+        seg_b = res;
+    }
+
+    /* Stejná znaménka se sečtou, různá se odečtou (menší absolutní hodnota od větší) a výsledek
+       převezme znaménko větší z nich. Sdílený operand leží na začátku výsledku, sčítá se tak na místě */
+    if (same_sign) {
+        if (na >= nb) {
+            res[na] = mpt_add_segments(res, seg_a, na, seg_b, nb);
+        } else {
+            res[nb] = mpt_add_segments(res, seg_b, nb, seg_a, na);
         }
+        return mpt_finish_(dest, negative_b);
     }
 
-    for (i = 0; i < bits_a; ++i) {
-        bit_a = mpt_get_bit(a, bits_a - i - 1);
-        bit_b = mpt_get_bit(b, bits_a - i - 1);
-        
-        RETURN_IF(bit_a > bit_b, 1);
-        RETURN_IF(bit_a < bit_b, -1);
+    if (cmp >= 0) {
+        mpt_sub_segments(res, seg_a, na, seg_b, nb);
+        return mpt_finish_(dest, mpt_is_negative(a));
     }
 
-    return 0;
+    mpt_sub_segments(res, seg_b, nb, seg_a, na);
+    return mpt_finish_(dest, negative_b);
+}
+
+int mpt_compare(const mpt a, const mpt b) {
+    int magnitude;
 
-    #undef RETURN_IF
+    /* Instance se sdílenými segmenty se mohou lišit znaménkem (např. po mpt_abs) */
+    if (a.capacity && b.capacity && a.limbs == b.limbs && a.size == b.size && a.negative == b.negative) {
+        return 0;
+    }
+    if (mpt_is_negative(a) != mpt_is_negative(b)) {
+        return mpt_is_negative(a) ? -1 : 1;
+    }
+
+    /* Hodnoty mají stejné znaménko, u záporných je větší ta s menší absolutní hodnotou */
+    magnitude = mpt_cmp_segments(MPT_SEGMENTS(a), mpt_segment_count(a), MPT_SEGMENTS(b), mpt_segment_count(b));
+    return mpt_is_negative(a) ? -magnitude : magnitude;
 }
 
 int mpt_signum(const mpt value) {
@@ -93,215 +156,271 @@ int mpt_signum(const mpt value) {
 }
 
 int mpt_abs(mpt *dest, const mpt value) {
-    if (!dest) {
+    if (!dest || !mpt_clone(dest, value)) {
         return 0;
     }
-    if (mpt_is_negative(value)) {
-        return mpt_negate(dest, value);
-    }
-    return mpt_clone(dest, value);
+
+    dest->negative = 0;
+    return 1;
 }
 
 int mpt_shift(mpt *dest, const mpt value, const size_t positions, const int shift_left) {
-    size_t i, j, bits_to_move;
+    const size_t count = mpt_segment_count(value);
+    const size_t seg_shift = positions / SEGMENT_BITS;
+    const unsigned int bit_shift = (unsigned int)(positions % SEGMENT_BITS);
+    const segment_type *orig = MPT_SEGMENTS(value);
+    size_t i, segments, low;
+    segment_type *res, lost = 0;
+    int shared;
 
-    #define EXIT_IF(v) \
-        if (v) { \
-            mpt_deinit(dest); \
-            return 0; \
-        }
-
-    EXIT_IF(!dest);
+    if (!dest) {
+        return 0;
+    }
+    shared = mpt_shares_segments_(dest, value);
 
-    EXIT_IF(!mpt_init(dest, 0));
+    /* Posun doprava zaokrouhluje dolů jako aritmetický posun v doplňkovém kódu, záporná hodnota
+       s vysunutými jedničkami se proto zvětší o jedna a potřebuje rezervu jednoho segmentu */
+    if (shift_left) {
+        segments = count + seg_shift + 1;
+    } else {
+        segments = (seg_shift < count ? count - seg_shift : 1) + 1;
+    }
 
-    bits_to_move = mpt_bit_count(value) + mpt_bits_in_segment(value);
+    /* Sdílené segmenty se posouvají na místě, dokud se nepřesunou, musí zůstat všechny */
+    if (!mpt_prepare_(dest, shared && count > segments ? count : segments, shared)) {
+        return 0;
+    }
+    res = MPT_SEGMENTS(*dest);
+    if (shared) {
+        orig = res;
+    }
 
     if (shift_left) {
-        i = 0;
-        j = positions;
+        if (bit_shift == 0) {
+            memmove(res + seg_shift, orig, count * sizeof(segment_type));
+        } else {
+            res[segments - 1] = mpt_lshift_segments(res + seg_shift, orig, count, bit_shift);
+        }
+        memset(res, 0, seg_shift * sizeof(segment_type));
+        return mpt_finish_(dest, mpt_is_negative(value));
+    }
 
-        EXIT_IF(!vector_realloc(dest->list, bits_to_move / mpt_bits_in_segment(*dest)));
-    } else {
-        i = positions;
-        j = 0;
+    for (i = 0; i < seg_shift && i < count; ++i) {
+        lost |= orig[i];
     }
 
-    for (; i < bits_to_move; ++i, ++j) {
-        EXIT_IF(!mpt_set_bit_to(dest, j, mpt_get_bit(value, i)));
+    low = 0;
+    if (seg_shift < count) {
+        low = count - seg_shift;
+        if (bit_shift == 0) {
+            memmove(res, orig + seg_shift, low * sizeof(segment_type));
+        } else {
+            lost |= mpt_rshift_segments(res, orig + seg_shift, low, bit_shift);
+        }
     }
 
-    EXIT_IF(!vector_remove(dest->list, 1));
-    EXIT_IF(!mpt_optimize(dest));
+    /* Nad posunutou hodnotou mohou u sdílených segmentů zůstat původní segmenty */
+    memset(res + low, 0, (segments - low) * sizeof(segment_type));
+    mpt_resize(dest, segments);
 
-    return 1;
+    if (mpt_is_negative(value) && lost) {
+        mpt_add_1_segments(res, res, segments, 1);
+    }
 
-    #undef EXIT_IF
+    return mpt_finish_(dest, mpt_is_negative(value));
 }
 
 int mpt_negate(mpt *dest, const mpt value) {
-    int res = 1;
-    size_t i;
-    segment_type segment;
-    mpt negated, one;
-    negated.list = one.list = NULL;
+    if (!dest || !mpt_clone(dest, value)) {
+        return 0;
+    }
 
-    #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
-        }
+    dest->negative = !mpt_is_negative(value) && !mpt_is_zero(value);
+    return 1;
+}
 
-    EXIT_IF(!dest, 0);
+int mpt_add(mpt *dest, const mpt a, const mpt b) {
+    return mpt_add_sub_(dest, a, b, 0);
+}
 
-    EXIT_IF(!mpt_init(&one, 1), 0);
-    EXIT_IF(!mpt_init(&negated, 0), 0);
+int mpt_sub(mpt *dest, const mpt a, const mpt b) {
+    return mpt_add_sub_(dest, a, b, 1);
+}
 
-    EXIT_IF(!vector_clear(negated.list), 0);
+int mpt_add_ui(mpt *dest, const mpt a, const segment_type b) {
+    const segment_type *seg_a = MPT_SEGMENTS(a);
+    const size_t n = mpt_segment_count(a);
+    segment_type *res;
+    int shared;
 
-    for (i = 0; i < mpt_segment_count(value); ++i) {
-        segment = ~(mpt_get_segment(value, i));
-        EXIT_IF(!vector_push_back(negated.list, &segment), 0);
+    if (!dest) {
+        return 0;
     }
+    shared = mpt_shares_segments_(dest, a);
 
-    EXIT_IF(!mpt_add(dest, negated, one), 0);
-
-  clean_and_exit:
-    mpt_deinit(&one);
-    mpt_deinit(&negated);
-
-    if (!res) {
-        mpt_deinit(dest);
+    /* Záporná hodnota menší než b v absolutní hodnotě má jediný segment a výsledek je kladný */
+    if (mpt_is_negative(a) && n == 1 && seg_a[0] < b) {
+        return mpt_init(dest, b - seg_a[0]);
     }
 
-    return res;
-
-    #undef EXIT_IF
-}
-
-int mpt_add(mpt *dest, const mpt a, const mpt b) {
-    segment_type segment_a, segment_b, res = 0, carry = 0;
-    size_t i, segments;
-
-    #define EXIT_IF(v) \
-        if (v) { \
-            mpt_deinit(dest); \
-            return 0; \
-        }
-        
-    EXIT_IF(!dest);
+    /* Výsledek se vejde do o jeden segment delší hodnoty, přenos se šíří jen tak daleko, kam je potřeba */
+    if (!mpt_prepare_(dest, n + 1, shared)) {
+        return 0;
+    }
+    res = MPT_SEGMENTS(*dest);
+    if (shared) {
+        seg_a = res;
+    }
 
-    if (mpt_bit_count(a) >= mpt_bit_count(b)) {
-        segments = mpt_segment_count(a);
+    if (mpt_is_negative(a)) {
+        mpt_sub_1_segments(res, seg_a, n, b);
     } else {
-        segments = mpt_segment_count(b);
+        res[n] = mpt_add_1_segments(res, seg_a, n, b);
     }
-    ++segments;
-
-    EXIT_IF(!mpt_init(dest, 0));
-    EXIT_IF(!vector_realloc(dest->list, segments));
-    EXIT_IF(!vector_clear(dest->list));
 
-    for (i = 0; i < segments; ++i) {
-        segment_a = mpt_get_segment(a, i);
-        segment_b = mpt_get_segment(b, i);
+    return mpt_finish_(dest, mpt_is_negative(a));
+}
 
-        res = segment_a + segment_b + carry;
-        carry = addition_carry_(segment_a, segment_b, carry);
+int mpt_mul_ui(mpt *dest, const mpt a, const segment_type b) {
+    const size_t n = mpt_segment_count(a);
+    const segment_type *seg_a = MPT_SEGMENTS(a);
+    segment_type *res;
+    int shared;
 
-        EXIT_IF(!vector_push_back(dest->list, &res));
+    if (!dest) {
+        return 0;
     }
+    shared = mpt_shares_segments_(dest, a);
 
-    EXIT_IF(!mpt_optimize(dest));
-
-    return 1;
+    /* Součin absolutní hodnoty s jedním segmentem se vejde do n + 1 segmentů */
+    if (!mpt_prepare_(dest, n + 1, shared)) {
+        return 0;
+    }
+    res = MPT_SEGMENTS(*dest);
+    if (shared) {
+        seg_a = res;
+    }
+    res[n] = mpt_mul_1_segments(res, seg_a, n, b);
 
-    #undef EXIT_IF
+    return mpt_finish_(dest, mpt_is_negative(a));
 }
 
-int mpt_sub(mpt *dest, const mpt a, const mpt b) {
-    int res = 1;
-    mpt negated_b;
-    negated_b.list = NULL;
+/**
+ * \brief Do *dest zapíše součin zadaných hodnot mpt, absolutní hodnoty vynásobí zadanou funkcí.
+ * \param dest Ukazatel na výslednou instanci mpt.
+ * \param a Instance mpt s prvním činitelem.
+ * \param b Instance mpt s druhým činitelem.
+ * \param multiply Funkce, která násobí pole segmentů bez znaménka.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * \return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+static int mpt_mul_with_(mpt *dest, const mpt a, const mpt b, const segments_multiplier multiply, mpt_ctx *ctx) {
+    const size_t na = mpt_segment_count(a), nb = mpt_segment_count(b);
+    const int negative = mpt_is_negative(a) != mpt_is_negative(b);
+    segment_type *product;
+    int res;
 
     if (!dest) {
         return 0;
     }
 
-    if (!mpt_negate(&negated_b, b)) {
-        return 0;
+    if (mpt_is_zero(a) || mpt_is_zero(b)) {
+        return mpt_init(dest, 0);
     }
 
-    res = mpt_add(dest, a, negated_b);
-    mpt_deinit(&negated_b);
+    /* Součin se nesmí překrývat s činiteli, při sdílení segmentů se proto spočte do pomocné paměti */
+    if (mpt_shares_segments_(dest, a) || mpt_shares_segments_(dest, b)) {
+        if (!(product = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_result, (na + nb) * sizeof(segment_type)))) {
+            return 0;
+        }
+        res = multiply(product, MPT_SEGMENTS(a), na, MPT_SEGMENTS(b), nb, ctx) && mpt_store_(dest, product, na + nb, negative);
+        mpt_ctx_release(ctx, product);
+        return res;
+    }
 
-    return res;
+    /* Součin absolutních hodnot má nejvýše na + nb segmentů */
+    if (!mpt_init_segments(dest, na + nb)) {
+        return 0;
+    }
+    if (!multiply(MPT_SEGMENTS(*dest), MPT_SEGMENTS(a), na, MPT_SEGMENTS(b), nb, ctx)) {
+        mpt_deinit(dest);
+        return 0;
+    }
+
+    return mpt_finish_(dest, negative);
 }
 
 int mpt_mul(mpt *dest, const mpt a, const mpt b) {
-    int res = 1;
-    size_t i, max_bits, to_remove;
-    mpt added, shifted;
-    added.list = shifted.list = NULL;
+    return mpt_mul_with_(dest, a, b, mpt_mul_segments, NULL);
+}
 
-    #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
-        }
+int mpt_mul_ctx(mpt *dest, const mpt a, const mpt b, mpt_ctx *ctx) {
+    return mpt_mul_with_(dest, a, b, mpt_mul_segments, ctx);
+}
 
-    EXIT_IF(!dest, 0);
+int mpt_mul_fft(mpt *dest, const mpt a, const mpt b) {
+    return mpt_mul_with_(dest, a, b, mpt_mul_segments_fft, NULL);
+}
 
-    EXIT_IF(!mpt_init(dest, 0), 0);
+int mpt_sqr(mpt *dest, const mpt a) {
+    return mpt_sqr_ctx(dest, a, NULL);
+}
 
-    if (mpt_is_zero(a) || mpt_is_zero(b)) {
-        return 1;
+int mpt_sqr_ctx(mpt *dest, const mpt a, mpt_ctx *ctx) {
+    const size_t na = mpt_segment_count(a);
+    segment_type *square;
+    int res;
+
+    if (!dest) {
+        return 0;
     }
 
-    if (mpt_bit_count(a) >= mpt_bit_count(b)) {
-        max_bits = mpt_bit_count(a);
-    } else {
-        max_bits = mpt_bit_count(b);
+    if (mpt_is_zero(a)) {
+        return mpt_init(dest, 0);
     }
-    max_bits *= 2;
 
-    for (i = 0; i < max_bits; ++i) {
-        if (mpt_get_bit(b, i) == 0) {
-            continue;
+    /* Druhá mocnina je vždy nezáporná a má nejvýše 2 * na segmentů */
+    if (mpt_shares_segments_(dest, a)) {
+        if (!(square = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_result, 2 * na * sizeof(segment_type)))) {
+            return 0;
         }
-        
-        EXIT_IF(!mpt_shift(&shifted, a, i, 1), 0);
-        EXIT_IF(!mpt_add(&added, *dest, shifted), 0);
-        mpt_deinit(&shifted);
-        mpt_replace(dest, &added);
+        res = mpt_sqr_segments(square, MPT_SEGMENTS(a), na, ctx) && mpt_store_(dest, square, 2 * na, 0);
+        mpt_ctx_release(ctx, square);
+        return res;
     }
 
-    if (mpt_bit_count(*dest) > max_bits) {
-        to_remove = (mpt_bit_count(*dest) - max_bits) / mpt_bits_in_segment(*dest);
-        EXIT_IF(!vector_remove(dest->list, to_remove), 0);
+    if (!mpt_init_segments(dest, 2 * na)) {
+        return 0;
     }
-    
-    EXIT_IF(!mpt_optimize(dest), 0);
-
-  clean_and_exit:
-    mpt_deinit(&added);
-    mpt_deinit(&shifted);
-    
-    if (!res) {
+    if (!mpt_sqr_segments(MPT_SEGMENTS(*dest), MPT_SEGMENTS(a), na, ctx)) {
         mpt_deinit(dest);
+        return 0;
     }
 
-    return res;
+    return mpt_finish_(dest, 0);
+}
 
-    #undef EXIT_IF
+/**
+ * \brief Zjistí, zda výsledná instance sdílí segmenty s dělencem nebo dělitelem.
+ * \param dest Ukazatel na výslednou instanci mpt, nebo NULL.
+ * \param dividend Instance mpt s dělencem.
+ * \param divisor Instance mpt s dělitelem.
+ * \return int 1 pokud instance sdílí segmenty s některým z operandů, jinak 0.
+ */
+static int mpt_divmod_shares_(const mpt *dest, const mpt dividend, const mpt divisor) {
+    return dest && (mpt_shares_segments_(dest, dividend) || mpt_shares_segments_(dest, divisor));
 }
 
-int mpt_div(mpt *dest, const mpt dividend, const mpt divisor) {
-    size_t current_bit;
-    int res = 1, is_res_negative = 0;
-    mpt negative, part, part_shifted, one, abs_dividend, sub, abs_divisor;
-    negative.list = part.list = part_shifted.list = one.list = NULL;
-    abs_dividend.list = sub.list = abs_divisor.list = NULL;
+int mpt_divmod(mpt *quotient, mpt *remainder, const mpt dividend, const mpt divisor) {
+    return mpt_divmod_ctx(quotient, remainder, dividend, divisor, NULL);
+}
+
+int mpt_divmod_ctx(mpt *quotient, mpt *remainder, const mpt dividend, const mpt divisor, mpt_ctx *ctx) {
+    int res = 1, shared;
+    segment_type *q = NULL, *r = NULL, *buffer = NULL;
+    const size_t na = mpt_segment_count(dividend), nb = mpt_segment_count(divisor);
+    const int negative_q = mpt_is_negative(dividend) != mpt_is_negative(divisor);
+    const int negative_r = mpt_is_negative(dividend);
 
     #define EXIT_IF(v, e) \
         if (v) { \
@@ -309,79 +428,114 @@ int mpt_div(mpt *dest, const mpt dividend, const mpt divisor) {
             goto clean_and_exit; \
         }
 
-    EXIT_IF(!dest, 0);
+    if (!quotient && !remainder) {
+        return 0;
+    }
 
     EXIT_IF(mpt_is_zero(divisor), 0);
 
-    EXIT_IF(!mpt_init(&one, 1), 0);
+    /* Dělenec s menším počtem segmentů je menší než dělitel. Zbytek se zapíše dřív, podíl pak smí přepsat dělence */
+    if (na < nb) {
+        EXIT_IF(remainder && !mpt_clone(remainder, dividend), 0);
+        EXIT_IF(quotient && !mpt_init(quotient, 0), 0);
+        goto clean_and_exit;
+    }
 
-    if (mpt_compare(divisor, one) == 0) {
-        mpt_deinit(&one);
-        return mpt_clone(dest, dividend);
+    /* Podíl má nejvýše na - nb + 1 segmentů a zbytek nejvýše nb segmentů. Nesmí se překrývat s operandy,
+       při sdílení segmentů se proto spočtou do pomocné paměti */
+    shared = mpt_divmod_shares_(quotient, dividend, divisor) || mpt_divmod_shares_(remainder, dividend, divisor);
+    if (shared) {
+        EXIT_IF(!(buffer = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_result, (na + 1) * sizeof(segment_type))), 0);
+        q = quotient ? buffer : NULL;
+        r = remainder ? buffer + na - nb + 1 : NULL;
+    } else {
+        if (quotient) {
+            EXIT_IF(!mpt_init_segments(quotient, na - nb + 1), 0);
+            q = MPT_SEGMENTS(*quotient);
+        }
+        if (remainder) {
+            EXIT_IF(!mpt_init_segments(remainder, nb), 0);
+            r = MPT_SEGMENTS(*remainder);
+        }
     }
 
-    EXIT_IF(!mpt_abs(&abs_dividend, dividend), 0);
-    EXIT_IF(!mpt_abs(&abs_divisor, divisor), 0);
-    EXIT_IF(!mpt_init(&part, 0), 0);
-    EXIT_IF(!mpt_init(dest, 0), 0);
+    EXIT_IF(!mpt_divrem_segments(q, r, MPT_SEGMENTS(dividend), na, MPT_SEGMENTS(divisor), nb, ctx), 0);
 
-    is_res_negative = mpt_is_negative(dividend) != mpt_is_negative(divisor);
-    current_bit = mpt_bit_count(abs_dividend) - 1;
+    /* Podíl se zaokrouhluje k nule, zbytek má proto znaménko dělence */
+    if (shared) {
+        EXIT_IF(q && !mpt_store_(quotient, q, na - nb + 1, negative_q), 0);
+        EXIT_IF(r && !mpt_store_(remainder, r, nb, negative_r), 0);
+    } else {
+        EXIT_IF(q && !mpt_finish_(quotient, negative_q), 0);
+        EXIT_IF(r && !mpt_finish_(remainder, negative_r), 0);
+    }
 
-    for (;;) {
-        while (mpt_compare(part, abs_divisor) < 0) {
-            EXIT_IF(!mpt_set_bit_to(dest, current_bit, 0), 0);
+  clean_and_exit:
+    if (buffer) {
+        mpt_ctx_release(ctx, buffer);
+    }
+    if (!res) {
+        mpt_deinit(quotient);
+        mpt_deinit(remainder);
+    }
 
-            if (current_bit == 0) {
-                goto clean_and_exit;
-            }
+    return res;
 
-            EXIT_IF(!mpt_shift(&part_shifted, part, 1, 1), 0);
-            EXIT_IF(!mpt_set_bit_to(&part_shifted, 0, mpt_get_bit(abs_dividend, --current_bit)), 0);
-            mpt_replace(&part, &part_shifted);
-        }
+    #undef EXIT_IF
+}
 
-        EXIT_IF(!mpt_set_bit_to(dest, current_bit, 1), 0);
+int mpt_div(mpt *dest, const mpt dividend, const mpt divisor) {
+    if (!dest) {
+        return 0;
+    }
 
-        if (current_bit == 0) {
-            goto clean_and_exit;
-        }
+    return mpt_divmod(dest, NULL, dividend, divisor);
+}
 
-        EXIT_IF(!mpt_sub(&sub, part, abs_divisor), 0);
-        mpt_deinit(&part);
-        EXIT_IF(!mpt_shift(&part, sub, 1, 1), 0);
-        mpt_deinit(&sub);
+int mpt_divmod_ui(mpt *quotient, segment_type *remainder, const mpt dividend, const segment_type divisor) {
+    const size_t n = mpt_segment_count(dividend);
+    const segment_type *seg = MPT_SEGMENTS(dividend);
+    segment_type rem;
+    int shared;
 
-        EXIT_IF(!mpt_set_bit_to(&part, 0, mpt_get_bit(abs_dividend, --current_bit)), 0);
+    if (!quotient || divisor == 0) {
+        return 0;
     }
+    shared = mpt_shares_segments_(quotient, dividend);
 
+    /* Dělení jedním segmentem smí přepisovat dělence na místě */
+    if (!mpt_prepare_(quotient, n, shared)) {
+        return 0;
+    }
+    if (shared) {
+        seg = MPT_SEGMENTS(*quotient);
+    }
 
-  clean_and_exit:
-    mpt_deinit(&one);
-    mpt_deinit(&part);
-    mpt_deinit(&part_shifted);
-    mpt_deinit(&abs_dividend);
-    mpt_deinit(&abs_divisor);
+    rem = mpt_divrem_1_segments(MPT_SEGMENTS(*quotient), seg, n, divisor);
 
-    if (res && is_res_negative) {
-        res = mpt_negate(&negative, *dest);
-        mpt_replace(dest, &negative);
+    if (!mpt_finish_(quotient, mpt_is_negative(dividend))) {
+        return 0;
     }
 
-    if (!res) {
-        mpt_deinit(dest);
+    if (remainder) {
+        *remainder = rem;
     }
+    return 1;
+}
 
-    return res;
+int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor) {
+    if (!dest) {
+        return 0;
+    }
 
-    #undef EXIT_IF
+    return mpt_divmod(NULL, dest, dividend, divisor);
 }
 
-int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor) {
+int mpt_mod_with_div(mpt *dest, const mpt dividend, const mpt divisor, const mpt div_result) {
     int res = 1;
-    mpt div, mul;
-    div.list = mul.list = NULL;
-
+    mpt mul;
+    mul.size = 0;
+    
     #define EXIT_IF(v, e) \
         if (v) { \
             res = e; \
@@ -390,12 +544,10 @@ int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor) {
 
     EXIT_IF(!dest, 0);
 
-    EXIT_IF(!mpt_div(&div, dividend, divisor), 0);
-    EXIT_IF(!mpt_mul(&mul, div, divisor), 0);
+    EXIT_IF(!mpt_mul(&mul, div_result, divisor), 0);
     EXIT_IF(!mpt_sub(dest, dividend, mul), 0);
 
   clean_and_exit:
-    mpt_deinit(&div);
     mpt_deinit(&mul);
     
     if (!res) {
@@ -407,28 +559,124 @@ int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor) {
     #undef EXIT_IF
 }
 
-int mpt_mod_with_div(mpt *dest, const mpt dividend, const mpt divisor, const mpt div_result) {
+/**
+ * \brief Vrátí at-tý bit nezáporné hodnoty zadané polem segmentů.
+ * \param segments Ukazatel na segmenty hodnoty.
+ * \param at Index bitu (musí ležet uvnitř segmentů).
+ * \return int Hodnota bitu (0 nebo 1).
+ */
+static int segments_bit_(const segment_type *segments, const size_t at) {
+    return (segments[at / SEGMENT_BITS] >> (at % SEGMENT_BITS)) & 1;
+}
+
+/**
+ * \brief Zjistí, zda je hodnota mpt rovna 1 nebo -1.
+ * \param value Instance mpt.
+ * \return int 1 pro hodnotu 1, -1 pro hodnotu -1, jinak 0.
+ */
+static int mpt_unit_(const mpt value) {
+    if (mpt_segment_count(value) != 1 || MPT_SEGMENTS(value)[0] != 1) {
+        return 0;
+    }
+
+    return mpt_is_negative(value) ? -1 : 1;
+}
+
+/**
+ * \brief Zvolí šířku okna podle délky exponentu. Okno šířky k stojí 2^(k - 1) násobení na přípravu tabulky
+ *        a ušetří zhruba bits / (k + 1) násobení, hranice odpovídají minimu jejich součtu.
+ * \param bits Počet bitů exponentu.
+ * \return size_t Šířka okna (1 .. MAX_POW_WINDOW).
+ */
+static size_t pow_window_size_(const size_t bits) {
+    static const size_t limits[MAX_POW_WINDOW - 1] = { 6, 24, 80, 240, 672 };
+    size_t window = 1;
+
+    while (window < MAX_POW_WINDOW && bits > limits[window - 1]) {
+        ++window;
+    }
+
+    return window;
+}
+
+/**
+ * \brief Umocní hodnotu mpt posuvným oknem zleva doprava. Předpočítá liché mocniny základu base^1, base^3, ..., base^(2^k - 1),
+ *        nulové bity exponentu zpracuje umocněním na druhou a skupiny nejvýše k bitů končící jedničkou
+ *        k umocnění na druhou jedním násobením hodnotou z tabulky.
+ * \param dest Ukazatel na výslednou instanci mpt.
+ * \param base Instance mpt se základem.
+ * \param exponent Ukazatel na segmenty kladného exponentu.
+ * \param bits Počet bitů exponentu, nejvyšší z nich je nastavený.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * \return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+static int mpt_pow_window_(mpt *dest, const mpt base, const segment_type *exponent, const size_t bits, mpt_ctx *ctx) {
     int res = 1;
-    mpt mul;
-    mul.list = NULL;
-    
+    size_t window, table_size, pos, low, index, i;
+    mpt table[1 << (MAX_POW_WINDOW - 1)], square, x, tmp;
+    square.size = x.size = tmp.size = 0;
+
     #define EXIT_IF(v, e) \
         if (v) { \
             res = e; \
             goto clean_and_exit; \
         }
 
-    EXIT_IF(!dest, 0);
+    window = pow_window_size_(bits);
+    table_size = (size_t)1 << (window - 1);
+    for (i = 0; i < table_size; ++i) {
+        table[i].size = 0;
+    }
 
-    EXIT_IF(!mpt_mul(&mul, div_result, divisor), 0);
-    EXIT_IF(!mpt_sub(dest, dividend, mul), 0);
+    EXIT_IF(!mpt_clone(&table[0], base), 0);
+    if (table_size > 1) {
+        EXIT_IF(!mpt_sqr_ctx(&square, base, ctx), 0);
+        for (i = 1; i < table_size; ++i) {
+            EXIT_IF(!mpt_mul_ctx(&table[i], table[i - 1], square, ctx), 0);
+        }
+    }
+
+    for (pos = bits; pos > 0; pos = low) {
+        if (!segments_bit_(exponent, pos - 1)) {
+            EXIT_IF(!mpt_sqr_ctx(&tmp, x, ctx), 0);
+            mpt_swap(&x, &tmp);
+            low = pos - 1;
+            continue;
+        }
+
+        /* Okno bitů low .. pos - 1 začíná i končí jedničkou, jeho hodnota je lichá */
+        low = pos > window ? pos - window : 0;
+        while (!segments_bit_(exponent, low)) {
+            ++low;
+        }
+        for (index = 0, i = pos; i > low; --i) {
+            index = (index << 1) | segments_bit_(exponent, i - 1);
+        }
+
+        /* Nejvyšší bit exponentu je nastavený, první okno proto jen převezme hodnotu z tabulky */
+        if (!x.size) {
+            EXIT_IF(!mpt_clone(&x, table[index / 2]), 0);
+            continue;
+        }
+
+        for (i = low; i < pos; ++i) {
+            EXIT_IF(!mpt_sqr_ctx(&tmp, x, ctx), 0);
+            mpt_swap(&x, &tmp);
+        }
+        EXIT_IF(!mpt_mul_ctx(&tmp, x, table[index / 2], ctx), 0);
+        mpt_swap(&x, &tmp);
+    }
+
+    /* Původní obsah výsledné instance se uvolní s pomocnými instancemi */
+    mpt_swap(dest, &x);
 
   clean_and_exit:
-    mpt_deinit(&mul);
-    
-    if (!res) {
-        mpt_deinit(dest);
+    for (i = 0; i < table_size; ++i) {
+        mpt_deinit(&table[i]);
     }
+    mpt_deinit(&square);
+    mpt_deinit(&x);
+    mpt_deinit(&tmp);
 
     return res;
 
@@ -436,10 +684,16 @@ int mpt_mod_with_div(mpt *dest, const mpt dividend, const mpt divisor, const mpt
 }
 
 int mpt_pow(mpt *dest, const mpt base, const mpt exponent) {
-    int res = 1;
-    size_t i, mssb_pos;
-    mpt x, mul;
-    x.list = mul.list = NULL;
+    return mpt_pow_ctx(dest, base, exponent, NULL);
+}
+
+int mpt_pow_ctx(mpt *dest, const mpt base, const mpt exponent, mpt_ctx *ctx) {
+    int res = 1, unit;
+    const segment_type *seg_base, *seg_exp;
+    size_t bits, zeros, shift = 0, i;
+    const mpt *odd_base = &base;
+    mpt odd, x;
+    odd.size = x.size = 0;
 
     #define EXIT_IF(v, e) \
         if (v) { \
@@ -455,25 +709,52 @@ int mpt_pow(mpt *dest, const mpt base, const mpt exponent) {
     if (mpt_is_zero(exponent)) {
         return mpt_init(dest, 1);
     }
+    if (mpt_is_zero(base)) {
+        return mpt_init(dest, 0);
+    }
 
-    EXIT_IF(!mpt_clone(&x, base), 0);
+    seg_exp = MPT_SEGMENTS(exponent);
+    bits = mpt_segment_count(exponent) * SEGMENT_BITS;
+    while (!segments_bit_(seg_exp, bits - 1)) {
+        --bits;
+    }
 
-    mssb_pos = mpt_get_mssb_pos_(exponent);
-    for (i = 1; i <= mssb_pos; ++i) {
-        EXIT_IF(!mpt_mul(&mul, x, x), 0);
-        mpt_replace(&x, &mul);
+    /* base = odd * 2^zeros, takže base^exponent = odd^exponent * 2^(zeros * exponent) a mocnina dvou je jen posun */
+    seg_base = MPT_SEGMENTS(base);
+    for (zeros = 0; !segments_bit_(seg_base, zeros); ++zeros)
+        ;
 
-        if (mpt_get_bit(exponent, mssb_pos - i) == 1) {
-            EXIT_IF(!mpt_mul(&mul, x, base), 0);
-            mpt_replace(&x, &mul);
+    if (zeros > 0) {
+        /* Posun, který nejde vyjádřit v size_t, by se do paměti stejně nevešel */
+        EXIT_IF(bits > sizeof(size_t) * BITS_IN_BYTE, 0);
+        for (i = bits; i > 0; --i) {
+            shift = (shift << 1) | segments_bit_(seg_exp, i - 1);
         }
+        EXIT_IF(shift > (size_t)~(size_t)0 / zeros, 0);
+        shift *= zeros;
+
+        EXIT_IF(!mpt_shift(&odd, base, zeros, 0), 0);
+        odd_base = &odd;
     }
 
-    mpt_replace(dest, &x);
+    /* Základ 1 nebo -1 dá 1 nebo -1 podle parity exponentu */
+    unit = mpt_unit_(*odd_base);
+    if (unit) {
+        EXIT_IF(!mpt_init(&x, 1), 0);
+        x.negative = unit < 0 && segments_bit_(seg_exp, 0);
+    } else {
+        EXIT_IF(!mpt_pow_window_(&x, *odd_base, seg_exp, bits, ctx), 0);
+    }
+
+    if (shift > 0) {
+        EXIT_IF(!mpt_shift(dest, x, shift, 1), 0);
+    } else {
+        mpt_swap(dest, &x);
+    }
 
   clean_and_exit:
+    mpt_deinit(&odd);
     mpt_deinit(&x);
-    mpt_deinit(&mul);
 
     if (!res) {
         mpt_deinit(dest);
@@ -485,47 +766,29 @@ int mpt_pow(mpt *dest, const mpt base, const mpt exponent) {
 }
 
 int mpt_factorial(mpt *dest, const mpt value) {
-    int res = 1;
-    mpt x, index, index_next, one;
-    x.list = index.list = index_next.list = one.list = NULL;
+    segment_type n, i;
 
-    #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
-        }
-
-    EXIT_IF(!dest, 0);
-
-    EXIT_IF(mpt_is_negative(value), 0);
-
-    if (mpt_is_zero(value)) {
-        return mpt_init(dest, 1);
+    if (!dest || mpt_is_negative(value)) {
+        return 0;
     }
 
-    EXIT_IF(!mpt_init(dest, 1), 0);
-    EXIT_IF(!mpt_init(&one, 1), 0);
-    EXIT_IF(!mpt_init(&index, 1), 0);
-
-    while (mpt_compare(index, value) <= 0) {
-        EXIT_IF(!mpt_mul(&x, *dest, index), 0);
-        mpt_replace(dest, &x);
-
-        EXIT_IF(!mpt_add(&index_next, index, one), 0);
-        mpt_replace(&index, &index_next);
+    /* Faktoriál hodnoty větší než jeden segment by se do paměti stejně nevešel */
+    if (mpt_segment_count(value) > 1) {
+        return 0;
     }
+    n = mpt_get_segment(value, 0);
 
-  clean_and_exit:
-    mpt_deinit(&x);
-    mpt_deinit(&index);
-    mpt_deinit(&index_next);
-    mpt_deinit(&one);
-
-    if (!res) {
-        mpt_deinit(dest);
+    if (!mpt_init(dest, 1)) {
+        return 0;
     }
 
-    return res;
+    /* Součin se násobí na místě, paměť výsledku se zvětšuje jen občas */
+    for (i = 2; i <= n && i != 0; ++i) {
+        if (!mpt_mul_ui(dest, *dest, i)) {
+            mpt_deinit(dest);
+            return 0;
+        }
+    }
 
-    #undef EXIT_IF
+    return 1;
 }
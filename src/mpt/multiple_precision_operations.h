@@ -2,6 +2,12 @@
  * @file multiple_precision_operations.h
  * @author Hynek Moudrý (hmoudry@students.zcu.cz)
  * @brief Hlavičkový soubor s deklaracemi funkcí pro matematické operace nad instancemi struktur typu 'mpt'.
+ *        Výsledná instance 'dest' smí být prázdná (size 0) nebo inicializovaná a smí to být i některý z operandů
+ *        (např. mpt_add(&x, x, y)). Její paměť se znovu využije a zvětší se jen tehdy, když se do ní výsledek nevejde,
+ *        smyčky, které opakovaně upravují jednu hodnotu, tak téměř nealokují. Po neúspěšné operaci zůstane
+ *        výsledná instance prázdná nebo nezměněná, volající ji v obou případech uvolní funkcí mpt_deinit.
+ *        Varianty s příponou _ctx berou pomocnou paměť z kontextu mpt_ctx (viz multiple_precision_context.h),
+ *        při opakovaném volání se stejným kontextem tak pomocnou paměť nealokují.
  * @version 1.0
  * @date 2023-01-04
  */
@@ -10,6 +16,7 @@
 #define _MPT_OPERATIONS_H
 
 #include "multiple_precision_type.h"
+#include "multiple_precision_context.h"
 
 /**
  * @brief Definice ukazatele na obecnou funkci, která provádí matematickou operaci nad dvěma instancemi struktur typu 'mpt'
@@ -83,6 +90,16 @@ int mpt_add(mpt *dest, const mpt a, const mpt b);
  */
 int mpt_sub(mpt *dest, const mpt a, const mpt b);
 
+/**
+ * @brief Do *dest zapíše součet hodnoty mpt a nezáporného čísla velikosti jednoho segmentu.
+ *        Nealokuje žádnou pomocnou instanci mpt, stačí jeden průchod segmenty.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt s prvním sčítancem.
+ * @param b Druhý sčítanec.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_add_ui(mpt *dest, const mpt a, const segment_type b);
+
 /**
  * @brief Do *dest zapíše součin zadaných hodnot mpt.
  * @param dest Ukazatel na výslednou instanci mpt.
@@ -92,6 +109,54 @@ int mpt_sub(mpt *dest, const mpt a, const mpt b);
  */
 int mpt_mul(mpt *dest, const mpt a, const mpt b);
 
+/**
+ * @brief Pracuje stejně jako mpt_mul, pomocnou paměť ale bere z kontextu.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt s prvním činitelem.
+ * @param b Instance mpt s druhým činitelem.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_mul_ctx(mpt *dest, const mpt a, const mpt b, mpt_ctx *ctx);
+
+/**
+ * @brief Do *dest zapíše součin zadaných hodnot mpt vypočtený vždy pomocí číselně teoretické transformace
+ *        bez ohledu na práh nastavený funkcí mpt_set_fft_threshold. Slouží hlavně k měření výkonu.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt s prvním činitelem.
+ * @param b Instance mpt s druhým činitelem.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_mul_fft(mpt *dest, const mpt a, const mpt b);
+
+/**
+ * @brief Do *dest zapíše druhou mocninu zadané hodnoty mpt. Je rychlejší než mpt_mul(dest, a, a),
+ *        protože na každé úrovni násobení počítá jen druhé mocniny a vynechá opakované součiny.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt, která se umocní na druhou.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_sqr(mpt *dest, const mpt a);
+
+/**
+ * @brief Pracuje stejně jako mpt_sqr, pomocnou paměť ale bere z kontextu.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt, která se umocní na druhou.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_sqr_ctx(mpt *dest, const mpt a, mpt_ctx *ctx);
+
+/**
+ * @brief Do *dest zapíše součin hodnoty mpt a nezáporného čísla velikosti jednoho segmentu.
+ *        Nealokuje žádnou pomocnou instanci mpt, stačí jeden průchod segmenty.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param a Instance mpt s prvním činitelem.
+ * @param b Druhý činitel.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_mul_ui(mpt *dest, const mpt a, const segment_type b);
+
 /**
  * @brief Do *dest zapíše celočíselný podíl zadaných hodnot mpt.
  * @param dest Ukazatel na výslednou instanci mpt.
@@ -110,6 +175,39 @@ int mpt_div(mpt *dest, const mpt dividend, const mpt divisor);
  */
 int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor);
 
+/**
+ * @brief Jedním dělením zapíše do *quotient celočíselný podíl a do *remainder zbytek zadaných hodnot mpt.
+ *        Podíl se zaokrouhluje k nule a zbytek má stejné znaménko jako dělenec, stejně jako u mpt_div a mpt_mod.
+ * @param quotient Ukazatel na výslednou instanci mpt pro podíl, nebo NULL, pokud podíl není potřeba.
+ * @param remainder Ukazatel na výslednou instanci mpt pro zbytek, nebo NULL, pokud zbytek není potřeba.
+ * @param dividend Instance mpt s dělencem.
+ * @param divisor Instance mpt s delitelem.
+ * @return int 1 pokud se operace podařila, 0 pokud ne (nulový dělitel, oba výstupy NULL nebo nedostatek paměti).
+ */
+int mpt_divmod(mpt *quotient, mpt *remainder, const mpt dividend, const mpt divisor);
+
+/**
+ * @brief Pracuje stejně jako mpt_divmod, pomocnou paměť ale bere z kontextu.
+ * @param quotient Ukazatel na výslednou instanci mpt pro podíl, nebo NULL, pokud podíl není potřeba.
+ * @param remainder Ukazatel na výslednou instanci mpt pro zbytek, nebo NULL, pokud zbytek není potřeba.
+ * @param dividend Instance mpt s dělencem.
+ * @param divisor Instance mpt s delitelem.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne (nulový dělitel, oba výstupy NULL nebo nedostatek paměti).
+ */
+int mpt_divmod_ctx(mpt *quotient, mpt *remainder, const mpt dividend, const mpt divisor, mpt_ctx *ctx);
+
+/**
+ * @brief Vydělí hodnotu mpt kladným číslem velikosti jednoho segmentu. Podíl se zaokrouhluje k nule.
+ *        Nealokuje žádnou pomocnou instanci mpt a místo dělení segmentů násobí předpočtenou převrácenou hodnotou dělitele.
+ * @param quotient Ukazatel na výslednou instanci mpt pro podíl.
+ * @param remainder Ukazatel, kam se zapíše absolutní hodnota zbytku (znaménko zbytku je stejné jako znaménko dělence), nebo NULL.
+ * @param dividend Instance mpt s dělencem.
+ * @param divisor Nenulový dělitel.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_divmod_ui(mpt *quotient, segment_type *remainder, const mpt dividend, const segment_type divisor);
+
 /**
  * @brief Do *dest zapíše zbytek po celočíselném dělení zadaných hodnot mpt.
  * @param dest Ukazatel na výslednou instanci mpt.
@@ -121,7 +219,8 @@ int mpt_mod(mpt *dest, const mpt dividend, const mpt divisor);
 int mpt_mod_with_div(mpt *dest, const mpt dividend, const mpt divisor, const mpt div_result);
 
 /**
- * @brief Do *dest zapíše celočíselné umocnění zadaných hodnot mpt.
+ * @brief Do *dest zapíše celočíselné umocnění zadaných hodnot mpt. Mocniny dvou ze základu převede na posun,
+ *        zbytek základu umocní posuvným oknem, jehož šířka roste s délkou exponentu. Záporný exponent dá 0.
  * @param dest Ukazatel na výslednou instanci mpt.
  * @param base Instance mpt se základem.
  * @param exponent Instance mpt s exponentem.
@@ -129,6 +228,16 @@ int mpt_mod_with_div(mpt *dest, const mpt dividend, const mpt divisor, const mpt
  */
 int mpt_pow(mpt *dest, const mpt base, const mpt exponent);
 
+/**
+ * @brief Pracuje stejně jako mpt_pow, pomocnou paměť násobení ale bere z kontextu.
+ * @param dest Ukazatel na výslednou instanci mpt.
+ * @param base Instance mpt se základem.
+ * @param exponent Instance mpt s exponentem.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ * @return int 1 pokud se operace podařila, 0 pokud ne.
+ */
+int mpt_pow_ctx(mpt *dest, const mpt base, const mpt exponent, mpt_ctx *ctx);
+
 /**
  * @brief Do *dest zapíše faktoriál zadaných hodnot mpt.
  * @param dest Ukazatel na výslednou instanci mpt.
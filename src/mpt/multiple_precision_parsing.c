@@ -3,30 +3,6 @@
 #include <stdlib.h>
 #include "mpt.h"
 
-/**
- * \brief Nastavuje v instanci mpt 'most significant' bity na jedničku dokud nenarazí na již nastavený bit.
- *        Používá se když parsujeme řetězec s binární nebo hexadecimální zápornou hodnotu, abychom doplnily 
- *        jedničky doplňkového kódu v segmentech (např. "0b1101" -> 0b11111101).
- * \param target Ukazatel na instanci mpt.
- * \return int 1 jestli se nastavení bitů podařilo, 0 pokud ne.
- */
-static int fill_set_bits_(mpt *target) {
-    size_t i, bit_count;
-    if ((bit_count = mpt_bit_count(*target)) == 0) {
-        return 0;
-    }
-    
-    for (i = 0; i < bit_count; ++i) {
-        if (mpt_get_bit(*target, bit_count - i - 1) == 1) {
-            break;
-        }
-        if (!mpt_set_bit_to(target, bit_count - i - 1, 1)) {
-            return 0;
-        }
-    }
-    return 1;
-}
-
 /**
  * \brief Převede znak na odpovídající binární hodnotu 1 nebo 0.
  * \param c Znak na převedení.
@@ -82,139 +58,111 @@ int parse_char(const char c, const enum bases base) {
     return parser(c);
 }
 
-int mpt_parse_str_bin(mpt *dest, const char **str) {
-    int res = 1, msb_set, char_value;
-    mpt shifted;
-    shifted.list = NULL;
-    
-    #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
-        }
-
-    EXIT_IF(!dest || !str || !*str, 0);
-    
-    EXIT_IF(!mpt_init(dest, 0), 0);
-
-    EXIT_IF((char_value = parse_bin_char_(**str)) < 0, 0);
-
-    msb_set = char_value == 1;
-
-    while (char_value >= 0) {
-        EXIT_IF(!mpt_shift(&shifted, *dest, 1, 1), 0);
-        EXIT_IF(!mpt_set_bit_to(&shifted, 0, char_value), 0);
-        mpt_replace(dest, &shifted);
-        
-        char_value = parse_bin_char_(*(++*str));
-    }
+/**
+ * \brief Naparsuje řetězec v soustavě o základu 2^bits_per_char (binární nebo hexadecimální).
+ *        Číslice se zapisují přímo do segmentů od nejnižší, hodnota se tak sestaví jedním průchodem bez posouvání.
+ *        Nastavený nejvyšší bit první číslice znamená zápornou hodnotu v doplňkovém kódu (např. "0b1101" -> -3),
+ *        bity nad zápisem se pak doplní jedničkami a hodnota se zneguje na absolutní hodnotu.
+ * \param dest Ukazatel na neinicializovanou instanci mpt.
+ * \param str Ukazatel na řetězec, posune se za poslední zpracovanou číslici.
+ * \param parser Funkce, která převádí znak na hodnotu číslice.
+ * \param bits_per_char Počet bitů jedné číslice (dělitel SEGMENT_BITS).
+ * \return int 1 pokud se parsování podařilo, jinak 0.
+ */
+static int parse_str_pow2_(mpt *dest, const char **str, const char_parser parser, const size_t bits_per_char) {
+    const char *end;
+    size_t digits, bits, pos, i;
+    segment_type *segments, carry;
+    int negative;
 
-    if (msb_set) {
-        EXIT_IF(!fill_set_bits_(dest), 0);
+    if (!dest || !str || !*str || parser(**str) < 0) {
+        return 0;
     }
 
-  clean_and_exit:
-    mpt_deinit(&shifted);
+    for (end = *str; parser(*end) >= 0; ++end);
+    digits = (size_t)(end - *str);
+    bits = digits * bits_per_char;
 
-    if (!res) {
-        mpt_deinit(dest);
+    /* Nad zápisem zůstane vždy aspoň jeden bit pro doplnění jedniček */
+    if (!mpt_init_segments(dest, bits / SEGMENT_BITS + 1)) {
+        return 0;
     }
+    segments = MPT_SEGMENTS(*dest);
 
-    return res;
+    for (i = 0, pos = 0; i < digits; ++i, pos += bits_per_char) {
+        segments[pos / SEGMENT_BITS] |= (segment_type)parser(*(end - 1 - i)) << (pos % SEGMENT_BITS);
+    }
 
-    #undef EXIT_IF
-}
+    negative = (parser(**str) >> (bits_per_char - 1)) & 1;
+    if (negative) {
+        segments[bits / SEGMENT_BITS] |= ~(segment_type)0 << (bits % SEGMENT_BITS);
 
-int mpt_parse_str_dec(mpt *dest, const char **str) {
-    int res = 1, char_value;
-    mpt mpv_char, mul, added, ten;
-    mpv_char.list = mul.list = added.list = ten.list = NULL;
-
-     #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
+        /* -x = ~x + 1 */
+        for (i = 0, carry = 1; i < dest->size; ++i) {
+            segments[i] = ~segments[i] + carry;
+            carry = carry && segments[i] == 0;
         }
-
-    EXIT_IF(!dest || !str || !*str, 0);
-
-    EXIT_IF(!mpt_init(&ten, 10), 0);
-    EXIT_IF(!mpt_init(dest, 0), 0);
-
-    EXIT_IF((char_value = parse_dec_char_(**str)) < 0, 0);
-
-    while (char_value >= 0) {
-        EXIT_IF(!mpt_init(&mpv_char, char_value), 0);
-        EXIT_IF(!mpt_mul(&mul, *dest, ten), 0);
-        EXIT_IF(!mpt_add(&added, mul, mpv_char), 0);
-        mpt_deinit(&mpv_char);
-        mpt_deinit(&mul);
-        mpt_replace(dest, &added);
-
-        char_value = parse_dec_char_(*(++*str));
     }
+    dest->negative = negative;
+    *str = end;
 
-  clean_and_exit:
-    mpt_deinit(&ten);
-    mpt_deinit(&added);
-    mpt_deinit(&mpv_char);
-    mpt_deinit(&mul);
-
-    if (!res) {
+    if (!mpt_optimize(dest)) {
         mpt_deinit(dest);
+        return 0;
     }
 
-    return res;
-
-    #undef EXIT_IF
+    return 1;
 }
 
-int mpt_parse_str_hex(mpt *dest, const char **str) {
-    int res = 1, msb_set, char_value;
-    mpt added, mpv_char, shifted;
-    added.list = mpv_char.list = shifted.list = NULL;
-
-    #define EXIT_IF(v, e) \
-        if (v) { \
-            res = e; \
-            goto clean_and_exit; \
-        }
+int mpt_parse_str_bin(mpt *dest, const char **str) {
+    return parse_str_pow2_(dest, str, parse_bin_char_, 1);
+}
 
-    EXIT_IF(!dest || !str || !*str, 0);
-    
-    EXIT_IF(!mpt_init(dest, 0), 0);
+int mpt_parse_str_dec(mpt *dest, const char **str) {
+    int char_value, digits;
+    segment_type chunk, scale, *segments;
+    size_t used;
+    const char *end;
 
-    EXIT_IF((char_value = parse_hex_char_(**str)) < 0, 0);
+    if (!dest || !str || !*str || (char_value = parse_dec_char_(**str)) < 0) {
+        return 0;
+    }
 
-    msb_set = char_value >= 8;
+    /* Hodnota n číslic má méně než n * log2(10) < n / 3 * 10 + 10 bitů, segmenty se proto alokují jednou předem
+       (zaokrouhleno nahoru) a bloky číslic se do nich přinásobují na místě */
+    for (end = *str; parse_dec_char_(*end) >= 0; ++end);
+    if (!mpt_init_segments(dest, ((size_t)(end - *str) / 3 * 10 + 10) / SEGMENT_BITS + 1)) {
+        return 0;
+    }
+    segments = MPT_SEGMENTS(*dest);
+    used = 1;
 
+    /* Číslice se skládají po blocích, které se vejdou do segmentu, a hodnota se jimi rozšiřuje jedním průchodem */
     while (char_value >= 0) {
-        EXIT_IF(!mpt_init(&mpv_char, char_value), 0);
-        EXIT_IF(!mpt_shift(&shifted, *dest, BITS_IN_NIBBLE, 1), 0);
-        EXIT_IF(!mpt_add(&added, shifted, mpv_char), 0);
-        mpt_deinit(&mpv_char);
-        mpt_deinit(&shifted);
-        mpt_replace(dest, &added);
+        chunk = 0;
+        scale = 1;
 
-        char_value = parse_hex_char_(*(++*str));
-    }
+        for (digits = 0; char_value >= 0 && digits < DEC_CHUNK_DIGITS; ++digits) {
+            chunk = chunk * 10 + char_value;
+            scale *= 10;
+            char_value = parse_dec_char_(*(++*str));
+        }
 
-    if (msb_set) {
-        EXIT_IF(!fill_set_bits_(dest), 0);
+        if ((chunk = mpt_mul_1c_segments(segments, segments, used, scale, chunk))) {
+            segments[used++] = chunk;
+        }
     }
 
-  clean_and_exit:
-    mpt_deinit(&mpv_char);
-    mpt_deinit(&shifted);
-    mpt_deinit(&added);
-
-    if (!res) {
+    if (!mpt_optimize(dest)) {
         mpt_deinit(dest);
+        return 0;
     }
 
-    return res;
+    return 1;
+}
 
-    #undef EXIT_IF
+int mpt_parse_str_hex(mpt *dest, const char **str) {
+    return parse_str_pow2_(dest, str, parse_hex_char_, BITS_IN_NIBBLE);
 }
 
 int mpt_parse_str(mpt *dest, const char **str) {
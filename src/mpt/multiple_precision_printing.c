@@ -1,117 +1,259 @@
 #include <stdio.h>
+#include <string.h>
 #include "multiple_precision_printing.h"
+#include "multiple_precision_division.h"
 #include "multiple_precision_operations.h"
+#include "multiple_precision_segments.h"
+
+/** Největší počet mocnin DEC_CHUNK_BASE^(2^i) při dekadickém převodu, počet segmentů mocnin roste geometricky. */
+#define DEC_MAX_POWERS (sizeof(size_t) * BITS_IN_BYTE)
+
+/** Znaky hexadecimálních číslic podle hodnoty nibblu. */
+static const char hex_digits_[] = "0123456789abcdef";
+
+/**
+ * \brief Vrátí index nejnižšího nenulového segmentu absolutní hodnoty (0 pro nulu).
+ * \param value Ukazatel na instanci mpt.
+ * \return size_t Index nejnižšího nenulového segmentu.
+ */
+static size_t lowest_nonzero_segment_(const mpt *value) {
+    const segment_type *segments = MPT_SEGMENTS(*value);
+    size_t i;
+
+    for (i = 0; i + 1 < value->size && segments[i] == 0; ++i)
+        ;
+
+    return i;
+}
+
+/**
+ * \brief Vrátí at-tý segment hodnoty v doplňkovém kódu, ve kterém se vypisuje binární a hexadecimální tvar.
+ *        Doplněk -m = ~m + 1 se počítá po segmentech bez pomocné paměti: segmenty pod nejnižším nenulovým
+ *        segmentem zůstanou nulové, nejnižší nenulový segment se zneguje a vyšší segmenty se jen invertují.
+ * \param value Ukazatel na instanci mpt.
+ * \param lowest Index nejnižšího nenulového segmentu absolutní hodnoty (viz lowest_nonzero_segment_).
+ * \param at Index segmentu, za koncem hodnoty se vrací znaménkové rozšíření.
+ * \return segment_type At-tý segment v doplňkovém kódu.
+ */
+static segment_type twos_complement_segment_(const mpt *value, const size_t lowest, const size_t at) {
+    const segment_type *segments = MPT_SEGMENTS(*value);
+
+    if (!mpt_is_negative(*value)) {
+        return at < value->size ? segments[at] : 0;
+    }
+    if (at >= value->size) {
+        return ~(segment_type)0;
+    }
+    if (at < lowest) {
+        return 0;
+    }
+    return at == lowest ? (segment_type)0 - segments[at] : ~segments[at];
+}
 
 /**
- * \brief Vrátí nibble na požadované pozici v instanci mpt (např. pro 10001111 01000010 a pozici 2 vrátí char s hodnotou 15 (1111b)).
- *        Vzhledem k tomu že každý segment v mpt má dva nibbly, 
- *        funkce dokáže vrátit pouze nibbly ve spodní polovině bitů nejvyšší možné hodnoty mpt.
- * \param value Ukazatel na mpt.
+ * \brief Vrátí nibble na požadované pozici v doplňkovém kódu hodnoty (např. pro 10001111 01000010 a pozici 2 vrátí 15 (1111b)).
+ *        Počet bitů segmentu je násobkem BITS_IN_NIBBLE, nibble proto nikdy nepřesahuje hranici segmentu.
+ * \param value Ukazatel na instanci mpt.
+ * \param lowest Index nejnižšího nenulového segmentu absolutní hodnoty.
  * \param nibble_pos Pozice nibblu.
- * \return char s hodnotou nibblu.
+ * \return int s hodnotou nibblu.
+ */
+static int twos_complement_nibble_(const mpt *value, const size_t lowest, const size_t nibble_pos) {
+    const size_t bit_pos = nibble_pos * BITS_IN_NIBBLE;
+    return (int)((twos_complement_segment_(value, lowest, bit_pos / SEGMENT_BITS) >> (bit_pos % SEGMENT_BITS)) & 0xf);
+}
+
+/**
+ * \brief Zapíše blok dekadických číslic doplněný úvodními nulami na DEC_CHUNK_DIGITS znaků. Segment může být širší
+ *        než unsigned long (64bitové segmenty na platformách s 32bitovým long), číslice se proto skládají ručně.
+ * \param out Ukazatel na místo pro DEC_CHUNK_DIGITS znaků.
+ * \param chunk Blok číslic, menší než DEC_CHUNK_BASE.
+ */
+static void chunk_write_(char *out, segment_type chunk) {
+    int i;
+
+    for (i = DEC_CHUNK_DIGITS; i > 0; --i) {
+        out[i - 1] = (char)('0' + chunk % 10);
+        chunk /= 10;
+    }
+}
+
+/**
+ * \brief Zapíše hodnotu 'x' jako přesně 'digits' dekadických číslic včetně úvodních nul.
+ *        Opakovaně dělí hodnotu na místě základem DEC_CHUNK_BASE a bloky číslic zapisuje od konce,
+ *        počet operací proto roste kvadraticky s počtem segmentů. Hodnota 'x' se přepíše.
+ * \param out Ukazatel na místo pro 'digits' znaků.
+ * \param digits Počet číslic, násobek DEC_CHUNK_DIGITS a hodnota musí být menší než 10^digits.
+ * \param x Ukazatel na segmenty hodnoty.
+ * \param m Počet segmentů hodnoty.
  */
-static char mpt_get_nibble_(const mpt value, const size_t nibble_pos) {
-    char nibble = 0;
-    size_t i, bit_pos;
-    bit_pos = nibble_pos * BITS_IN_NIBBLE;
+static void dec_convert_basecase_(char *out, const size_t digits, segment_type *x, size_t m) {
+    char *end = out + digits;
 
-    for (i = 0; i < BITS_IN_NIBBLE; ++i) {
-        nibble += mpt_get_bit(value, bit_pos + i) << i;
+    while (m > 0 && x[m - 1] == 0) {
+        --m;
+    }
+    while (m > 0) {
+        end -= DEC_CHUNK_DIGITS;
+        chunk_write_(end, mpt_divrem_1_segments(x, x, m, DEC_CHUNK_BASE));
+        while (m > 0 && x[m - 1] == 0) {
+            --m;
+        }
     }
 
-    return nibble;
+    memset(out, '0', (size_t)(end - out));
 }
 
 /**
- * \brief Do konzole vypíše pozpátku řetězec uložený ve vektoru str. 
- *        Používá se při vypisování hodnoty mpt v dekadické formě, 
- *        protože algoritmus pro převod binární na dekadickou soustavu vypočítává jednotlivé číslice pozpátku. 
- * \param str Ukazatel na vektor s řetězcem, jenž má být vypsán pozpátku.
+ * \brief Zapíše hodnotu 'x' jako přesně 'digits' dekadických číslic včetně úvodních nul metodou rozděl a panuj.
+ *        Hodnotu menší než P^2 pro P = DEC_CHUNK_BASE^(2^(k-1)) vydělí mocninou P, podíl tvoří horní číslice
+ *        a zbytek spodních DEC_CHUNK_DIGITS * 2^(k-1) číslic. Obě poloviny se převedou rekurzivně s menší mocninou,
+ *        krátké hodnoty kvadratickým algoritmem. Dělení využívá rychlé násobení, převod je proto subkvadratický.
+ *        Podíl a zbytek se ukládají na začátek 'stack', vnořená volání pokračují za nimi. Hodnota 'x' se přepíše.
+ * \param out Ukazatel na místo pro 'digits' znaků.
+ * \param digits Počet číslic, násobek DEC_CHUNK_DIGITS a hodnota musí být menší než 10^digits.
+ * \param x Ukazatel na segmenty hodnoty.
+ * \param m Počet segmentů hodnoty.
+ * \param powers Pole mocnin DEC_CHUNK_BASE^(2^i) pro i = 0, 1, ...
+ * \param k Počet mocnin, které se smí použít, hodnota musí být menší než druhá mocnina poslední z nich.
+ * \param stack Ukazatel na pomocnou paměť pro podíly a zbytky (viz mpt_print_dec_ctx).
+ * \param ctx Ukazatel na kontext s pomocnou pamětí dělení, nebo NULL.
+ * \return int 1 pokud se převod podařil, 0 pokud ne.
  */
-void str_print_reverse_(const vector_type *str) {
-    size_t i;
-    for (i = 0; i < vector_count(str); ++i) {
-        printf("%d", *(char *)vector_at(str, vector_count(str) - i - 1));
+static int dec_convert_(char *out, const size_t digits, segment_type *x, size_t m,
+                        const mpt *powers, size_t k, segment_type *stack, mpt_ctx *ctx) {
+    const segment_type *power;
+    size_t len, low;
+
+    while (m > 0 && x[m - 1] == 0) {
+        --m;
     }
+
+    /* Hodnota menší než mocnina se jí nedělí, přejde se rovnou k menší mocnině */
+    while (m > MPT_DEC_DC_THRESHOLD && k > 0
+           && mpt_cmp_segments(x, m, MPT_SEGMENTS(powers[k - 1]), mpt_segment_count(powers[k - 1])) < 0) {
+        --k;
+    }
+    if (m <= MPT_DEC_DC_THRESHOLD || k == 0) {
+        dec_convert_basecase_(out, digits, x, m);
+        return 1;
+    }
+
+    power = MPT_SEGMENTS(powers[k - 1]);
+    len = mpt_segment_count(powers[k - 1]);
+    low = (size_t)DEC_CHUNK_DIGITS << (k - 1);
+
+    /* Podíl (m - len + 1 segmentů) a zbytek (len segmentů) jsou menší než mocnina */
+    if (!mpt_divrem_segments(stack, stack + m - len + 1, x, m, power, len, ctx)) {
+        return 0;
+    }
+
+    return dec_convert_(out, digits - low, stack, m - len + 1, powers, k - 1, stack + m + 1, ctx)
+        && dec_convert_(out + digits - low, low, stack + m - len + 1, len, powers, k - 1, stack + m + 1, ctx);
 }
 
 void mpt_print_bin(const mpt value) {
-    size_t i, bits;
-    int msb;
+    const size_t lowest = lowest_nonzero_segment_(&value);
+    size_t i, bit;
+    segment_type segment;
+    int msb, digit, started = 0;
 
     msb = mpt_get_msb(value);
 
     printf("0b%d", msb);
 
-    /* Ignoruj bity stejné jako MSB */
-    bits = mpt_bit_count(value);
-    for (i = 1; i < bits; ++i) {
-        if (mpt_get_bit(value, bits - i - 1) != msb) {
-            break;
-        }
-    }
+    /* Doplňkový kód má o segment víc než absolutní hodnota, bity stejné jako MSB na jeho začátku se vynechají */
+    for (i = mpt_segment_count(value) + 1; i > 0; --i) {
+        segment = twos_complement_segment_(&value, lowest, i - 1);
 
-    for (; i < bits; ++i) {
-        printf("%i", mpt_get_bit(value, bits - i - 1));
+        for (bit = SEGMENT_BITS; bit > 0; --bit) {
+            digit = (int)((segment >> (bit - 1)) & 1);
+            if (!started && digit == msb) {
+                continue;
+            }
+            started = 1;
+            putchar('0' + digit);
+        }
     }
 }
 
 void mpt_print_dec(const mpt value) {
-    vector_type *str;
-    mpt mod, div, div_next, ten;
-    mod.list = div.list = div_next.list = ten.list = NULL;
-    
+    mpt_print_dec_ctx(value, NULL);
+}
+
+void mpt_print_dec_ctx(const mpt value, mpt_ctx *ctx) {
+    const size_t n = mpt_segment_count(value);
+    /* Blok DEC_CHUNK_DIGITS číslic pokryje víc než 3 * DEC_CHUNK_DIGITS bitů, protože log2(10) > 3 */
+    const size_t digits = (n * SEGMENT_BITS / (3 * DEC_CHUNK_DIGITS) + 1) * DEC_CHUNK_DIGITS;
+    mpt powers[DEC_MAX_POWERS];
+    segment_type *x = NULL;
+    char *out;
+    size_t i, k = 0, stack = n + 1;
+
+    if (mpt_is_zero(value) == 1) {
+        printf("0");
+        return;
+    }
+
     #define EXIT_IF(v) \
         if (v) { \
             goto clean_and_exit; \
         }
 
-    if (mpt_is_zero(value) == 1) {
-        printf("0");
-        return;
+    /* Mocniny DEC_CHUNK_BASE^(2^i) se počítají, dokud druhá mocnina poslední z nich nepřevýší hodnotu */
+    if (n > MPT_DEC_DC_THRESHOLD) {
+        powers[k++].size = 0;
+        EXIT_IF(!mpt_init(&powers[0], DEC_CHUNK_BASE));
+        while (2 * mpt_segment_count(powers[k - 1]) - 2 < n && k < DEC_MAX_POWERS) {
+            powers[k++].size = 0;
+            EXIT_IF(!mpt_sqr_ctx(&powers[k - 1], powers[k - 2], ctx));
+        }
     }
 
-    EXIT_IF(!mpt_abs(&div, value));
-    EXIT_IF(!mpt_init(&ten, 10));
-    EXIT_IF(!(str = vector_allocate(sizeof(char), NULL)));
+    /* Vnořená volání dec_convert_ mají na zásobníku nejvýš jeden blok podílu a zbytku pro každou mocninu, blok volání
+       s i-tou mocninou má o segment víc než hodnota menší než (i+1)-ní mocnina, nejvyšší blok o segment víc než celá hodnota */
+    for (i = 1; i < k; ++i) {
+        stack += mpt_segment_count(powers[i]) + 1;
+    }
 
-    while (!mpt_is_zero(div)) {
-        EXIT_IF(!mpt_div(&div_next, div, ten));
-        EXIT_IF(!mpt_mod_with_div(&mod, div, ten, div_next));
-        mpt_replace(&div, &div_next);
+    EXIT_IF(!(x = (segment_type *)mpt_ctx_acquire(ctx, mpt_slot_dec, (n + stack) * sizeof(segment_type) + digits)));
+    out = (char *)(x + n + stack);
 
-        EXIT_IF(!vector_push_back(str, vector_at(mod.list, 0)));
+    /* Převádí se kopie absolutní hodnoty, znaménko se vypíše zvlášť */
+    memcpy(x, MPT_SEGMENTS(value), n * sizeof(segment_type));
+    EXIT_IF(!dec_convert_(out, digits, x, n, powers, k, x + n, ctx));
+
+    for (i = 0; i + 1 < digits && out[i] == '0'; ++i)
+        ;
 
-        mpt_deinit(&mod);
-    }
-    
     if (mpt_is_negative(value)) {
         printf("-");
     }
-    str_print_reverse_(str);
+    fwrite(out + i, 1, digits - i, stdout);
 
   clean_and_exit:
-    vector_deallocate(&str);
-    mpt_deinit(&mod);
-    mpt_deinit(&div_next);
-    mpt_deinit(&div);
-    mpt_deinit(&ten);
+    if (x) {
+        mpt_ctx_release(ctx, x);
+    }
+    for (i = 0; i < k; ++i) {
+        mpt_deinit(&powers[i]);
+    }
 
     #undef EXIT_IF
 }
 
 void mpt_print_hex(const mpt value) {
-    int msb;
+    const size_t lowest = lowest_nonzero_segment_(&value);
+    int msb, nibble = 0, to_leave_out;
     size_t i, nibbles;
-    char nibble = 0, to_leave_out;
 
     msb = mpt_get_msb(value);
-    nibbles = mpt_bit_count(value) / BITS_IN_NIBBLE;
+    nibbles = (mpt_segment_count(value) + 1) * SEGMENT_BITS / BITS_IN_NIBBLE;
     
     to_leave_out = msb * 0xf;
     
     for (i = 0; i < nibbles; ++i) {
-        nibble = mpt_get_nibble_(value, nibbles - i - 1);
+        nibble = twos_complement_nibble_(&value, lowest, nibbles - i - 1);
 
         if (nibble != to_leave_out) {
             break;
@@ -128,22 +270,25 @@ void mpt_print_hex(const mpt value) {
     }
 
     if (i == nibbles) {
-        printf("%x", nibble);
+        putchar(hex_digits_[nibble]);
         return;
     }
 
     for (; i < nibbles; ++i) {
-        nibble = mpt_get_nibble_(value, nibbles - i - 1);
-        printf("%x", nibble);
+        putchar(hex_digits_[twos_complement_nibble_(&value, lowest, nibbles - i - 1)]);
     }
 }
 
 void mpt_print(const mpt value, const enum bases base) {
+    mpt_print_ctx(value, base, NULL);
+}
+
+void mpt_print_ctx(const mpt value, const enum bases base, mpt_ctx *ctx) {
     mpt_printer printer;
 
     switch (base) {
         case bin: printer = mpt_print_bin; break;
-        case dec: printer = mpt_print_dec; break;
+        case dec: mpt_print_dec_ctx(value, ctx); return;
         case hex: printer = mpt_print_hex; break;
         default:  return;
     }
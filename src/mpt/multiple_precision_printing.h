@@ -10,6 +10,16 @@
 #define _MPT_PRINT_H
 
 #include "multiple_precision_type.h"
+#include "multiple_precision_context.h"
+
+/**
+ * @brief Počet segmentů, do kterého se hodnota převádí do dekadické soustavy opakovaným dělením základem DEC_CHUNK_BASE.
+ *        Delší hodnoty se dělí mocninami tohoto základu metodou rozděl a panuj. Lze ho změnit při překladu
+ *        (-DMPT_DEC_DC_THRESHOLD=...).
+ */
+#ifndef MPT_DEC_DC_THRESHOLD
+#define MPT_DEC_DC_THRESHOLD 40
+#endif
 
 /**
  * @brief Definice ukazatele na obecnou funkci, která do konzole vypíše hodnotu instance mpt.
@@ -23,11 +33,20 @@ typedef void (*mpt_printer)(const mpt);
 void mpt_print_bin(const mpt value);
 
 /**
- * @brief Vypíše do konzole hodnotu instance mpt v dekadickém tvaru.
+ * @brief Vypíše do konzole hodnotu instance mpt v dekadickém tvaru. Dlouhé hodnoty převádí rekurzivním dělením
+ *        mocninami DEC_CHUNK_BASE^(2^i), které je díky rychlému dělení subkvadratické.
  * @param value Instance mpt.
  */
 void mpt_print_dec(const mpt value);
 
+/**
+ * @brief Pracuje stejně jako mpt_print_dec, kopii hodnoty, mezivýsledky převodu a číslice ale ukládá do pomocné
+ *        paměti kontextu, kterou používá i pro dělení a umocňování.
+ * @param value Instance mpt.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ */
+void mpt_print_dec_ctx(const mpt value, mpt_ctx *ctx);
+
 /**
  * @brief Vypíše do konzole hodnotu instance mpt v hexadecimálním tvaru.
  * @param value Instance mpt.
@@ -41,4 +60,12 @@ void mpt_print_hex(const mpt value);
  */
 void mpt_print(const mpt value, const enum bases base);
 
+/**
+ * @brief Pracuje stejně jako mpt_print, dekadický výpis ale bere pomocnou paměť z kontextu.
+ * @param value Instance mpt.
+ * @param base Požadovaná číselná soustava.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí, nebo NULL.
+ */
+void mpt_print_ctx(const mpt value, const enum bases base, mpt_ctx *ctx);
+
 #endif
\ No newline at end of file
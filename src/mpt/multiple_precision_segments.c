@@ -0,0 +1,180 @@
+#include "multiple_precision_segments.h"
+
+segment_type mpt_add_n_segments(segment_type *res, const segment_type *a, const segment_type *b, const size_t n) {
+    segment_type sum, carry = 0;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        sum = a[i] + carry;
+        carry = sum < carry;
+        sum += b[i];
+        carry |= sum < b[i];
+        res[i] = sum;
+    }
+
+    return carry;
+}
+
+segment_type mpt_sub_n_segments(segment_type *res, const segment_type *a, const segment_type *b, const size_t n) {
+    segment_type diff, borrow = 0, next;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        diff = a[i] - b[i];
+        next = a[i] < b[i];
+        res[i] = diff - borrow;
+        borrow = next | (diff < borrow);
+    }
+
+    return borrow;
+}
+
+segment_type mpt_add_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type b) {
+    segment_type carry = b;
+    size_t i;
+
+    for (i = 0; i < n && carry; ++i) {
+        res[i] = a[i] + carry;
+        carry = res[i] < carry;
+    }
+
+    /* Bez přenosu se zbytek jen opíše, při výpočtu na místě už není co dělat */
+    if (res != a) {
+        for (; i < n; ++i) {
+            res[i] = a[i];
+        }
+    }
+
+    return carry;
+}
+
+segment_type mpt_sub_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type b) {
+    segment_type borrow = b, x;
+    size_t i;
+
+    for (i = 0; i < n && borrow; ++i) {
+        x = a[i];
+        res[i] = x - borrow;
+        borrow = x < borrow;
+    }
+
+    if (res != a) {
+        for (; i < n; ++i) {
+            res[i] = a[i];
+        }
+    }
+
+    return borrow;
+}
+
+segment_type mpt_add_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb) {
+    return mpt_add_1_segments(res + nb, a + nb, na - nb, mpt_add_n_segments(res, a, b, nb));
+}
+
+segment_type mpt_sub_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb) {
+    return mpt_sub_1_segments(res + nb, a + nb, na - nb, mpt_sub_n_segments(res, a, b, nb));
+}
+
+segment_type mpt_mul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m) {
+    return mpt_mul_1c_segments(res, a, n, m, 0);
+}
+
+segment_type mpt_mul_1c_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m, segment_type carry) {
+    double_segment_type product;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        product = (double_segment_type)a[i] * m + carry;
+        res[i] = (segment_type)product;
+        carry = (segment_type)(product >> SEGMENT_BITS);
+    }
+
+    return carry;
+}
+
+segment_type mpt_addmul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m) {
+    double_segment_type t;
+    segment_type carry = 0;
+    size_t i;
+
+    /* a * m + res + carry < B^2, součet se tedy vždy vejde do dvou segmentů */
+    for (i = 0; i < n; ++i) {
+        t = (double_segment_type)a[i] * m + res[i] + carry;
+        res[i] = (segment_type)t;
+        carry = (segment_type)(t >> SEGMENT_BITS);
+    }
+
+    return carry;
+}
+
+segment_type mpt_submul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m) {
+    double_segment_type product;
+    segment_type carry = 0, low, x;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        product = (double_segment_type)a[i] * m + carry;
+        low = (segment_type)product;
+        carry = (segment_type)(product >> SEGMENT_BITS);
+        x = res[i];
+        res[i] = x - low;
+        carry += x < low;
+    }
+
+    return carry;
+}
+
+segment_type mpt_lshift_segments(segment_type *res, const segment_type *a, const size_t n, const unsigned int shift) {
+    const segment_type out = a[n - 1] >> (SEGMENT_BITS - shift);
+    size_t i;
+
+    /* Od nejvyššího segmentu, výsledek proto smí ležet i nad 'a' */
+    for (i = n - 1; i > 0; --i) {
+        res[i] = (a[i] << shift) | (a[i - 1] >> (SEGMENT_BITS - shift));
+    }
+    res[0] = a[0] << shift;
+
+    return out;
+}
+
+segment_type mpt_rshift_segments(segment_type *res, const segment_type *a, const size_t n, const unsigned int shift) {
+    const segment_type out = a[0] << (SEGMENT_BITS - shift);
+    size_t i;
+
+    for (i = 0; i + 1 < n; ++i) {
+        res[i] = (a[i] >> shift) | (a[i + 1] << (SEGMENT_BITS - shift));
+    }
+    res[n - 1] = a[n - 1] >> shift;
+
+    return out;
+}
+
+int mpt_cmp_n_segments(const segment_type *a, const segment_type *b, const size_t n) {
+    size_t i;
+
+    for (i = n; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] > b[i] ? 1 : -1;
+        }
+    }
+
+    return 0;
+}
+
+int mpt_cmp_segments(const segment_type *a, const size_t na, const segment_type *b, const size_t nb) {
+    size_t i;
+
+    /* Segmenty delšího pole nad délkou kratšího musí být nulové, jinak je delší pole větší */
+    for (i = na; i > nb; --i) {
+        if (a[i - 1] != 0) {
+            return 1;
+        }
+    }
+    for (i = nb; i > na; --i) {
+        if (b[i - 1] != 0) {
+            return -1;
+        }
+    }
+
+    return mpt_cmp_n_segments(a, b, na < nb ? na : nb);
+}
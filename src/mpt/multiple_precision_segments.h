@@ -0,0 +1,160 @@
+/**
+ * @file multiple_precision_segments.h
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Hlavičkový soubor s deklaracemi základních funkcí nad poli segmentů bez znaménka.
+ *        Funkce pracují s dvojicí (ukazatel na segmenty, počet segmentů), nic nealokují a nehlídají velikost výsledku,
+ *        tu musí připravit volající. Slouží jako společné jádro operací mpt, násobení a dělení.
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#ifndef _MPT_SEGMENTS_H
+#define _MPT_SEGMENTS_H
+
+#include "multiple_precision_type.h"
+
+/**
+ * @brief Sečte dvě stejně dlouhá pole segmentů. 'res' se smí shodovat s 'a' nebo 'b'.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty prvního sčítance.
+ * @param b Ukazatel na segmenty druhého sčítance.
+ * @param n Počet segmentů.
+ * @return segment_type Přenos z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_add_n_segments(segment_type *res, const segment_type *a, const segment_type *b, const size_t n);
+
+/**
+ * @brief Odečte dvě stejně dlouhá pole segmentů. 'res' se smí shodovat s 'a' nebo 'b'.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty menšence.
+ * @param b Ukazatel na segmenty menšitele.
+ * @param n Počet segmentů.
+ * @return segment_type Výpůjčka z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_sub_n_segments(segment_type *res, const segment_type *a, const segment_type *b, const size_t n);
+
+/**
+ * @brief Do 'res' zapíše 'a' zvětšené o segment 'b'. Pokud se 'res' shoduje s 'a', skončí hned, jak se přenos vynuluje.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty hodnoty.
+ * @param n Počet segmentů.
+ * @param b Přičítaný segment.
+ * @return segment_type Přenos z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_add_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type b);
+
+/**
+ * @brief Do 'res' zapíše 'a' zmenšené o segment 'b'. Pokud se 'res' shoduje s 'a', skončí hned, jak se výpůjčka vynuluje.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty hodnoty.
+ * @param n Počet segmentů.
+ * @param b Odečítaný segment.
+ * @return segment_type Výpůjčka z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_sub_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type b);
+
+/**
+ * @brief Sečte pole 'a' a kratší pole 'b' (nb <= na). 'res' se smí shodovat s 'a' nebo 'b'.
+ * @param res Ukazatel na na segmentů výsledku.
+ * @param a Ukazatel na segmenty delšího sčítance.
+ * @param na Počet segmentů delšího sčítance.
+ * @param b Ukazatel na segmenty kratšího sčítance.
+ * @param nb Počet segmentů kratšího sčítance.
+ * @return segment_type Přenos z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_add_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb);
+
+/**
+ * @brief Odečte od pole 'a' kratší pole 'b' (nb <= na). 'res' se smí shodovat s 'a' nebo 'b'.
+ * @param res Ukazatel na na segmentů výsledku.
+ * @param a Ukazatel na segmenty menšence.
+ * @param na Počet segmentů menšence.
+ * @param b Ukazatel na segmenty menšitele.
+ * @param nb Počet segmentů menšitele.
+ * @return segment_type Výpůjčka z nejvyššího segmentu (0 nebo 1).
+ */
+segment_type mpt_sub_segments(segment_type *res, const segment_type *a, const size_t na, const segment_type *b, const size_t nb);
+
+/**
+ * @brief Do 'res' zapíše součin pole 'a' se segmentem 'm'. 'res' se smí shodovat s 'a'.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty činitele.
+ * @param n Počet segmentů.
+ * @param m Segment, kterým se násobí.
+ * @return segment_type Nejvyšší (n + 1.) segment součinu.
+ */
+segment_type mpt_mul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m);
+
+/**
+ * @brief Do 'res' zapíše součin pole 'a' se segmentem 'm' zvětšený o segment 'carry'. 'res' se smí shodovat s 'a'.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty činitele.
+ * @param n Počet segmentů.
+ * @param m Segment, kterým se násobí.
+ * @param carry Segment přičtený k součinu.
+ * @return segment_type Nejvyšší (n + 1.) segment výsledku.
+ */
+segment_type mpt_mul_1c_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m, segment_type carry);
+
+/**
+ * @brief Přičte k poli 'res' součin pole 'a' se segmentem 'm'. 'res' se nesmí překrývat s 'a'.
+ * @param res Ukazatel na n segmentů, ke kterým se přičítá.
+ * @param a Ukazatel na segmenty činitele.
+ * @param n Počet segmentů.
+ * @param m Segment, kterým se násobí.
+ * @return segment_type Segment, který je ještě potřeba přičíst nad nejvyšší segment 'res'.
+ */
+segment_type mpt_addmul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m);
+
+/**
+ * @brief Odečte od pole 'res' součin pole 'a' se segmentem 'm'. 'res' se nesmí překrývat s 'a'.
+ * @param res Ukazatel na n segmentů, od kterých se odečítá.
+ * @param a Ukazatel na segmenty činitele.
+ * @param n Počet segmentů.
+ * @param m Segment, kterým se násobí.
+ * @return segment_type Segment, který je ještě potřeba odečíst nad nejvyšším segmentem 'res'.
+ */
+segment_type mpt_submul_1_segments(segment_type *res, const segment_type *a, const size_t n, const segment_type m);
+
+/**
+ * @brief Do 'res' zapíše pole 'a' posunuté doleva o 'shift' bitů (0 < shift < SEGMENT_BITS).
+ *        'res' se smí shodovat s 'a' nebo ležet nad ním, posun o celé segmenty tak jde provést na místě.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty hodnoty.
+ * @param n Počet segmentů (n >= 1).
+ * @param shift Počet bitů posunu.
+ * @return segment_type Bity vysunuté z nejvyššího segmentu (v nejnižších bitech).
+ */
+segment_type mpt_lshift_segments(segment_type *res, const segment_type *a, const size_t n, const unsigned int shift);
+
+/**
+ * @brief Do 'res' zapíše pole 'a' posunuté doprava o 'shift' bitů (0 < shift < SEGMENT_BITS).
+ *        'res' se smí shodovat s 'a' nebo ležet pod ním, posun o celé segmenty tak jde provést na místě.
+ * @param res Ukazatel na n segmentů výsledku.
+ * @param a Ukazatel na segmenty hodnoty.
+ * @param n Počet segmentů (n >= 1).
+ * @param shift Počet bitů posunu.
+ * @return segment_type Bity vysunuté z nejnižšího segmentu (v nejvyšších bitech).
+ */
+segment_type mpt_rshift_segments(segment_type *res, const segment_type *a, const size_t n, const unsigned int shift);
+
+/**
+ * @brief Porovná dvě stejně dlouhá pole segmentů.
+ * @param a Ukazatel na segmenty první hodnoty.
+ * @param b Ukazatel na segmenty druhé hodnoty.
+ * @param n Počet segmentů.
+ * @return int 1 pokud a > b, -1 pokud a < b, 0 pokud se rovnají.
+ */
+int mpt_cmp_n_segments(const segment_type *a, const segment_type *b, const size_t n);
+
+/**
+ * @brief Porovná dvě pole segmentů různé délky, nejvyšší segmenty mohou být nulové.
+ * @param a Ukazatel na segmenty první hodnoty.
+ * @param na Počet segmentů první hodnoty.
+ * @param b Ukazatel na segmenty druhé hodnoty.
+ * @param nb Počet segmentů druhé hodnoty.
+ * @return int 1 pokud a > b, -1 pokud a < b, 0 pokud se rovnají.
+ */
+int mpt_cmp_segments(const segment_type *a, const size_t na, const segment_type *b, const size_t nb);
+
+#endif
@@ -1,80 +1,221 @@
 #include <stdlib.h>
+#include <string.h>
 #include "multiple_precision_type.h"
+#include "../data_structures/arena.h"
 
 /**
- * \brief Přidá zadaný počet nulových segmentů do instance mpt.
- * \param value Ukazatel na instanci mpt.
- * \param segments_to_add Počet segmentů k přidání.
- * \return int 1 jestli se přidání podařilo, 0 pokud ne.
+ * \brief Hlavička bloku segmentů na haldě. Blok může sdílet několik instancí (viz mpt_clone), hlavička proto nese
+ *        jejich počet. Union zarovná segmenty za hlavičkou stejně, jako by blok začínal přímo jimi.
  */
-static int mpt_add_segments_(mpt *value, const size_t segments_to_add) {
-    size_t i;
-    int zero = 0;
-    if (!value || segments_to_add == 0) {
-        return 0;
-    }
+typedef union limb_header_ {
+    size_t refs;            /** Počet instancí, které blok sdílí. */
+    segment_type align;     /** Zarovnání segmentů za hlavičkou. */
+} limb_header;
 
-    for (i = 0; i < segments_to_add; ++i) {
-        if (!vector_push_back(value->list, &zero)) {
-            return 0;
-        }
+/** Vrátí ukazatel na hlavičku bloku, jehož segmenty začínají na adrese 'limbs'. */
+#define LIMB_HEADER(limbs) ((limb_header *)(limbs) - 1)
+
+/**
+ * \brief Alokuje blok segmentů s hlavičkou, který patří jediné instanci.
+ * \param capacity Počet segmentů.
+ * \param zero 1 pokud mají být segmenty vynulované, jinak 0.
+ * \return segment_type* Ukazatel na první segment bloku nebo NULL při chybě.
+ */
+static segment_type *limbs_allocate_(const size_t capacity, const int zero) {
+    const size_t bytes = sizeof(limb_header) + capacity * sizeof(segment_type);
+    limb_header *header;
+
+    if (capacity > ((size_t)-1 - sizeof(limb_header)) / sizeof(segment_type)) {
+        return NULL;
+    }
+    if (!(header = (limb_header *)(zero ? arena_calloc(1, bytes) : arena_malloc(bytes)))) {
+        return NULL;
     }
+    header->refs = 1;
 
-    return 1;
+    return (segment_type *)(header + 1);
 }
 
 /**
- * \brief Vrátí index segmentu s bitem na at-té pozici.
- * \param value Instance mpt.
- * \param at Pozice bitu, jehož segment chceme najít.
- * \return size_t Index segmentu s bitem na at-té pozici.
+ * \brief Zjistí, zda blok segmentů sdílí víc instancí. Do sdíleného bloku se nesmí zapisovat.
+ * \param limbs Ukazatel na první segment bloku.
+ * \return int 1 pokud je blok sdílený, jinak 0.
  */
-static size_t mpt_get_segment_index_(const mpt value, const size_t at) {
-    return at / mpt_bits_in_segment(value);
+static int limbs_shared_(const segment_type *limbs) {
+    return LIMB_HEADER(limbs)->refs > 1;
 }
 
 /**
- * \brief Vrátí index bitu v segmentu s bitem na at-té pozici.
- * \param value Instance mpt.
- * \param at Pozice bitu, jehož pozici v jemu příslušném segmentu chceme najít.
- * \return size_t Index bitu v segmentu s bitem na at-té pozici.
+ * \brief Vzdá se bloku segmentů. Blok se uvolní, až se ho vzdá poslední instance, která ho sdílí.
+ * \param limbs Ukazatel na první segment bloku.
  */
-static size_t mpt_bit_pos_in_segment_(const mpt value, const size_t at) {
-    return at % mpt_bits_in_segment(value);
+static void limbs_release_(segment_type *limbs) {
+    limb_header *header = LIMB_HEADER(limbs);
+
+    if (--header->refs == 0) {
+        arena_free(header);
+    }
 }
 
 int mpt_init(mpt *value, const segment_type init_value) {
     segment_type *default_segment;
+
+    if (!mpt_init_segments(value, 1)) {
+        return 0;
+    }
     
-    if (!value) {
+    if (!(default_segment = mpt_get_segment_ptr(value, 0))) {
+        mpt_deinit(value);
         return 0;
     }
+    *default_segment = init_value;
+
+    return 1;
+}
 
-    if (!(value->list = vector_allocate(sizeof(segment_type), NULL))) {
+int mpt_init_segments(mpt *value, const size_t segments) {
+    if (!value || segments == 0) {
         return 0;
     }
 
-    if (!mpt_add_segments_(value, 1)) {
-        mpt_deinit(value);
+    /* Inicializovaná instance si paměť na haldě ponechá, pokud se do ní segmenty vejdou a nesdílí ji s jinou instancí */
+    if (value->size && value->capacity && (value->capacity < segments || limbs_shared_(value->limbs))) {
+        limbs_release_(value->limbs);
+        value->size = 0;
+    }
+
+    if (value->size && value->capacity) {
+        memset(value->limbs, 0, segments * sizeof(segment_type));
+    } else if (segments <= MPT_INLINE_SEGMENTS) {
+        value->capacity = 0;
+        memset(value->small, 0, segments * sizeof(segment_type));
+    } else {
+        if (!(value->limbs = limbs_allocate_(segments, 1))) {
+            value->size = value->capacity = 0;
+            return 0;
+        }
+        value->capacity = segments;
+    }
+    value->size = segments;
+    value->negative = 0;
+
+    return 1;
+}
+
+int mpt_resize(mpt *value, const size_t segments) {
+    size_t capacity;
+    segment_type *limbs;
+    limb_header *header;
+    int shared;
+
+    if (!value || segments == 0) {
         return 0;
     }
-    
-    if (!(default_segment = mpt_get_segment_ptr(*value, 0))) {
+
+    /* Prázdná instance nemá žádnou paměť ani znaménko */
+    if (!value->size) {
+        value->capacity = 0;
+        value->negative = 0;
+    }
+    shared = value->capacity && limbs_shared_(value->limbs);
+    capacity = value->capacity ? value->capacity : MPT_INLINE_SEGMENTS;
+
+    /* Sdílené segmenty se před zápisem zkopírují do vlastního bloku, ostatní instance je dál sdílí beze změny */
+    if (segments > capacity || shared) {
+        if (segments > capacity) {
+            capacity = segments > 2 * capacity ? segments : 2 * capacity;
+        }
+        if (value->capacity && !shared) {
+            header = (limb_header *)arena_realloc(LIMB_HEADER(value->limbs), sizeof(limb_header) + capacity * sizeof(segment_type));
+            limbs = header ? (segment_type *)(header + 1) : NULL;
+        } else if ((limbs = limbs_allocate_(capacity, 0)) != NULL) {
+            memcpy(limbs, MPT_SEGMENTS(*value), (value->size < segments ? value->size : segments) * sizeof(segment_type));
+            if (shared) {
+                limbs_release_(value->limbs);
+            }
+        }
+        if (!limbs) {
+            return 0;
+        }
+        value->limbs = limbs;
+        value->capacity = capacity;
+    }
+
+    if (segments > value->size) {
+        memset(MPT_SEGMENTS(*value) + value->size, 0, (segments - value->size) * sizeof(segment_type));
+    }
+    value->size = segments;
+
+    return 1;
+}
+
+int mpt_init_long(mpt *value, const long init_value) {
+    const size_t segments = (sizeof(long) + sizeof(segment_type) - 1) / sizeof(segment_type);
+    const size_t half = SEGMENT_BITS / 2;
+    unsigned long bits;
+    segment_type *seg;
+    size_t i;
+
+    if (!mpt_init_segments(value, segments)) {
+        return 0;
+    }
+    seg = MPT_SEGMENTS(*value);
+
+    /* Absolutní hodnota LONG_MIN se do long nevejde, v unsigned long se ale spočte správně */
+    bits = init_value < 0 ? 0UL - (unsigned long)init_value : (unsigned long)init_value;
+    value->negative = init_value < 0;
+
+    /* Posun po polovinách segmentu je definovaný i pro segment široký jako long */
+    for (i = 0; i < segments; ++i) {
+        seg[i] = (segment_type)bits;
+        bits = (bits >> half) >> half;
+    }
+
+    if (!mpt_optimize(value)) {
         mpt_deinit(value);
         return 0;
     }
-    *default_segment = init_value;
 
     return 1;
 }
 
+int mpt_get_long(const mpt value, long *out) {
+    const size_t half = SEGMENT_BITS / 2;
+    size_t i, count = mpt_segment_count(value);
+    const segment_type *seg;
+    unsigned long bits;
+
+    if (!out || count == 0 || count * sizeof(segment_type) > sizeof(long)) {
+        return 0;
+    }
+    seg = MPT_SEGMENTS(value);
+
+    bits = 0;
+    for (i = count; i > 0; --i) {
+        bits = ((bits << half) << half) | seg[i - 1];
+    }
+
+    if (bits > (unsigned long)LONG_MAX + value.negative) {
+        return 0;
+    }
+
+    /* Převod hodnoty větší než LONG_MAX na long není v C89 definovaný, LONG_MIN se proto skládá zvlášť */
+    if (!value.negative) {
+        *out = (long)bits;
+    } else {
+        *out = bits > (unsigned long)LONG_MAX ? LONG_MIN : -(long)bits;
+    }
+    return 1;
+}
+
 mpt *mpt_allocate(const segment_type init_value) {
-    mpt *new = (mpt *)malloc(sizeof(mpt));
+    mpt *new = (mpt *)arena_malloc(sizeof(mpt));
     if (!new) {
         return NULL;
     }
 
-    new->list = NULL;
+    new->size = new->capacity = 0;
+    new->limbs = NULL;
 
     if (!mpt_init(new, init_value)) {
         mpt_deallocate(&new);
@@ -84,11 +225,31 @@ mpt *mpt_allocate(const segment_type init_value) {
 }
 
 int mpt_clone(mpt *dest, const mpt orig) {
-    if (!dest) {
+    if (!dest || !orig.size) {
+        return 0;
+    }
+
+    /* Segmenty na haldě se nekopírují, klon je sdílí, dokud do některé z instancí nikdo nezapíše.
+       Instance, která už segmenty hodnoty drží, jen převezme velikost a znaménko */
+    if (orig.capacity) {
+        if (!(dest->size && dest->capacity && dest->limbs == orig.limbs)) {
+            ++LIMB_HEADER(orig.limbs)->refs;
+            mpt_deinit(dest);
+            dest->limbs = orig.limbs;
+            dest->capacity = orig.capacity;
+        }
+        dest->size = orig.size;
+        dest->negative = orig.negative;
+        return 1;
+    }
+
+    if (!mpt_init_segments(dest, orig.size)) {
         return 0;
     }
 
-    return (dest->list = vector_clone(orig.list)) != NULL;
+    memcpy(MPT_SEGMENTS(*dest), MPT_SEGMENTS(orig), orig.size * sizeof(segment_type));
+    dest->negative = orig.negative;
+    return 1;
 }
 
 void mpt_replace(mpt *to_replace, mpt *replace_with) {
@@ -97,141 +258,112 @@ void mpt_replace(mpt *to_replace, mpt *replace_with) {
     }
     mpt_deinit(to_replace);
     *to_replace = *replace_with;
-    replace_with->list = NULL;
+    replace_with->size = 0;
+}
+
+void mpt_swap(mpt *a, mpt *b) {
+    mpt tmp;
+
+    if (!a || !b) {
+        return;
+    }
+    tmp = *a;
+    *a = *b;
+    *b = tmp;
 }
 
 size_t mpt_bits_in_segment(const mpt value) {
-    return value.list->item_size * BITS_IN_BYTE;
+    (void)value;
+    return SEGMENT_BITS;
 }
 
 size_t mpt_segment_count(const mpt value) {
-    return vector_count(value.list);
+    return value.size;
 }
 
 size_t mpt_bit_count(const mpt value) {
-    return mpt_segment_count(value) * mpt_bits_in_segment(value);
+    return value.size * SEGMENT_BITS;
 }
 
-segment_type *mpt_get_segment_ptr(const mpt value, const size_t at) {
-    return (segment_type *)vector_at(value.list, at);
+segment_type *mpt_get_segment_ptr(const mpt *value, const size_t at) {
+    if (!value || at >= value->size) {
+        return NULL;
+    }
+
+    return MPT_SEGMENTS(*value) + at;
 }
 
 segment_type mpt_get_segment(const mpt value, const size_t at) {
-    if (at >= mpt_segment_count(value)) {
-        return mpt_get_msb(value) * ~0;
+    if (at >= value.size) {
+        return 0;
     }
 
-    return *mpt_get_segment_ptr(value, at);
+    return MPT_SEGMENTS(value)[at];
 }
 
 int mpt_set_bit_to(mpt *value, const size_t at, const int bit_set) {
-    size_t segment_pos, to_add, bit_pos;
-    segment_type *segment;
-
-    segment_pos = mpt_get_segment_index_(*value, at);
-    bit_pos = mpt_bit_pos_in_segment_(*value, at);
-
-    if (segment_pos >= mpt_segment_count(*value)) {
-        to_add = segment_pos - mpt_segment_count(*value) + 1;
-        if (!mpt_add_segments_(value, to_add)) {
-            return 0;
-        }
-    }
+    const size_t segment_pos = at / SEGMENT_BITS;
+    const segment_type mask = (segment_type)1 << (at % SEGMENT_BITS);
+    segment_type *segments;
 
-    segment = mpt_get_segment_ptr(*value, segment_pos);
-
-    if (!segment) {
+    /* Změna velikosti přidá chybějící segmenty a sdílené segmenty před zápisem zkopíruje */
+    if (!mpt_resize(value, segment_pos >= value->size ? segment_pos + 1 : value->size)) {
         return 0;
     }
+    segments = MPT_SEGMENTS(*value);
 
     if (bit_set) {
-        *segment |= (1 << bit_pos);
+        segments[segment_pos] |= mask;
     } else {
-        *segment &= ~(1 << bit_pos);
+        segments[segment_pos] &= ~mask;
     }
 
     return 1;
 }
 
 int mpt_get_bit(const mpt value, const size_t at) {
-    segment_type segment;
-    size_t bit_pos;
-
     if (at >= mpt_bit_count(value)) {
-        return mpt_get_msb(value);
+        return 0;
     }
-    segment = mpt_get_segment(value, mpt_get_segment_index_(value, at));
-    bit_pos = mpt_bit_pos_in_segment_(value, at);
 
-    return (segment >> bit_pos) & 1;
+    return (int)((MPT_SEGMENTS(value)[at / SEGMENT_BITS] >> (at % SEGMENT_BITS)) & 1);
 }
 
 int mpt_get_msb(const mpt value) {
-    return mpt_get_bit(value, mpt_bit_count(value) - 1);
+    return value.negative;
 }
 
 int mpt_is_zero(const mpt value) {
-    segment_type *segment = NULL;
-    size_t i;
-
-    for (i = 0; i < mpt_segment_count(value); ++i) {
-        segment = mpt_get_segment_ptr(value, i);
-        if (!segment || *segment != 0) {
-            return 0;
-        }
-    }
-
-    return 1;
+    return value.size == 1 && MPT_SEGMENTS(value)[0] == 0;
 }
 
 int mpt_is_negative(const mpt value) {
-    return mpt_get_msb(value);
+    return value.negative;
 }
 
 int mpt_is_odd(const mpt value) {
-    return mpt_get_bit(value, 0);
+    return (int)(MPT_SEGMENTS(value)[0] & 1);
 }
 
 int mpt_optimize(mpt *orig) {
-    segment_type segments_to_remove, *segment;
-    size_t i, last_segment;
-    int msb;
-
-    #define EXIT_IF(v) \
-        if (v) { \
-            return 0; \
-        }
-
-    EXIT_IF(!orig);
-
-    msb = mpt_get_msb(*orig);
-    segments_to_remove = msb * ~0;
+    const segment_type *segments;
+    size_t count;
 
-    for (i = 0; i < mpt_segment_count(*orig); ++i) {
-        last_segment = mpt_segment_count(*orig) - i - 1;
-        EXIT_IF(!(segment = mpt_get_segment_ptr(*orig, last_segment)));
-
-        if (*segment != segments_to_remove) {
-            break;
-        }
-    }
-
-    /* V případě samých nul, nebo samých jedniček nechceme odstranit všechny segmenty */
-    if (i == mpt_segment_count(*orig)) {
-        --i;
+    if (!orig || orig->size == 0) {
+        return 0;
     }
 
-    EXIT_IF(!vector_remove(orig->list, i));
+    segments = MPT_SEGMENTS(*orig);
+    for (count = orig->size; count > 1 && segments[count - 1] == 0; --count)
+        ;
+    orig->size = count;
 
-    if (mpt_get_msb(*orig) != msb) {
-        mpt_add_segments_(orig, 1);
-        EXIT_IF(!(segment = mpt_get_segment_ptr(*orig, mpt_segment_count(*orig) - 1)));
-        *segment = segments_to_remove;
+    /* Nula nemá znaménko, záporná nula by se jinak lišila od kladné */
+    if (count == 1 && segments[0] == 0) {
+        orig->negative = 0;
     }
 
     return 1;
-    
-    #undef EXIT_IF
 }
 
 void mpt_deinit(mpt *value) {
@@ -239,7 +371,10 @@ void mpt_deinit(mpt *value) {
         return;
     }
 
-    vector_deallocate(&(value->list));
+    if (value->size && value->capacity) {
+        limbs_release_(value->limbs);
+    }
+    value->size = value->capacity = 0;
 }
 
 void mpt_deallocate(mpt **value) {
@@ -248,6 +383,6 @@ void mpt_deallocate(mpt **value) {
     }
 
     mpt_deinit(*value);
-    free(*value);
+    arena_free(*value);
     *value = NULL;
 }
@@ -9,7 +9,8 @@
 #ifndef _MPT_BASE_H
 #define _MPT_BASE_H
 
-#include "../data_structures/vector.h"
+#include <limits.h>
+#include <stddef.h>
 
 #define BITS_IN_BYTE 8
 #define BITS_IN_NIBBLE 4
@@ -19,20 +20,120 @@
  */
 enum bases { bin = 2, dec = 10, hex = 16 };
 
+/**
+ * @brief Šířka segmentu v bitech, 32 nebo 64. Volí se při překladu (-DMPT_SEGMENT_BITS=...).
+ *        64bitové segmenty potřebují pro mezivýsledky násobení a dělení typ unsigned __int128 (GCC a Clang
+ *        na 64bitových platformách), bez něj se použijí 32bitové segmenty.
+ */
+#ifndef MPT_SEGMENT_BITS
+#ifdef __SIZEOF_INT128__
+#define MPT_SEGMENT_BITS 64
+#else
+#define MPT_SEGMENT_BITS 32
+#endif
+#endif
+
+#if MPT_SEGMENT_BITS == 64
+
+#ifndef __SIZEOF_INT128__
+#error "64bitové segmenty vyžadují překladač s typem unsigned __int128."
+#endif
+
+/** 
+ * @brief Uživatelský typ pro jednotlivé segmenty v instancích struktury mpt.
+ */
+#if ULONG_MAX > 0xffffffffUL
+typedef unsigned long segment_type;
+#else
+__extension__ typedef unsigned long long segment_type;
+#endif
+
+/** 
+ * @brief Typ s dvojnásobnou šířkou segmentu. Používá se pro mezivýsledky při násobení a dělení segmentů.
+ */
+__extension__ typedef unsigned __int128 double_segment_type;
+
+/** 
+ * @brief Největší počet dekadických číslic, jejichž hodnota (i 10^DEC_CHUNK_DIGITS) se vždy vejde do jednoho segmentu.
+ *        Dekadický převod proto pracuje po blocích těchto číslic.
+ */
+#define DEC_CHUNK_DIGITS 19
+
+/** @brief 10^DEC_CHUNK_DIGITS (C89 nemá konstanty typu unsigned long long, hodnota se proto skládá násobením). */
+#define DEC_CHUNK_BASE ((segment_type)1000000000 * 1000000000 * 10)
+
+#elif MPT_SEGMENT_BITS == 32
+
+#if UINT_MAX != 0xffffffffUL
+#error "32bitové segmenty předpokládají 32bitový typ unsigned int."
+#endif
+
 /** 
  * @brief Uživatelský typ pro jednotlivé segmenty v instancích struktury mpt.
  */
 typedef unsigned int segment_type;
 
+/** 
+ * @brief Typ s dvojnásobnou šířkou segmentu. Používá se pro mezivýsledky při násobení a dělení segmentů.
+ */
+#if ULONG_MAX > UINT_MAX
+typedef unsigned long double_segment_type;
+#else
+__extension__ typedef unsigned long long double_segment_type;
+#endif
+
+/** 
+ * @brief Největší počet dekadických číslic, jejichž hodnota (i 10^DEC_CHUNK_DIGITS) se vždy vejde do jednoho segmentu.
+ *        Dekadický převod proto pracuje po blocích těchto číslic.
+ */
+#define DEC_CHUNK_DIGITS 9
+
+/** @brief 10^DEC_CHUNK_DIGITS. */
+#define DEC_CHUNK_BASE 1000000000
+
+#else
+#error "MPT_SEGMENT_BITS musí být 32 nebo 64."
+#endif
+
+/** 
+ * @brief Počet bitů v jednom segmentu. Je známý při překladu, takže dělení a zbytky podle něj překladač převede na posuny.
+ */
+#define SEGMENT_BITS (sizeof(segment_type) * BITS_IN_BYTE)
+
+/**
+ * @brief Počet segmentů, které se ukládají přímo do instance mpt. Větší hodnoty se ukládají na haldu.
+ *        Lze ho změnit při překladu (-DMPT_INLINE_SEGMENTS=...).
+ */
+#ifndef MPT_INLINE_SEGMENTS
+#define MPT_INLINE_SEGMENTS 2
+#endif
+
 /** 
  * @brief Struktura mpt_
  * Představuje "multiple precision type", tedy celočíselný datový typ s vysokou přesností, který je dynamicky alokovaný.
  * Na 64-bitovém stroji může představovat čísla v rozsahu  <-2^(2^63), 2^(2^63)-1>.
+ * Hodnota je uložena jako znaménko a absolutní hodnota. Segmenty absolutní hodnoty jsou normalizované (nejvyšší segment
+ * je nenulový, nula má jeden nulový segment a je vždy nezáporná), zjištění znaménka, nuly i negace tak nevyžadují
+ * průchod segmenty. Malé hodnoty (nejvýše MPT_INLINE_SEGMENTS segmentů) leží přímo v instanci
+ * a nealokují žádnou paměť, větší hodnoty mají segmenty v jednom bloku na haldě. Blok na haldě může sdílet několik
+ * instancí (viz mpt_clone), zapisovat do něj smí jen funkce, které ho předtím zkopírují (mpt_init_segments, mpt_resize).
+ * Instance se smí kopírovat přiřazením, segmenty se ale vždy čtou přes mpt_get_segment_ptr nebo MPT_SEGMENTS z instance, které patří.
  */
 typedef struct mpt_ {
-    vector_type *list;
+    size_t size;                                /** Počet segmentů absolutní hodnoty, 0 u neinicializované instance. */
+    size_t capacity;                            /** Počet segmentů alokovaných v 'limbs', 0 pokud jsou segmenty v 'small'. */
+    segment_type *limbs;                        /** Segmenty na haldě, platné jen při nenulové kapacitě. */
+    segment_type small[MPT_INLINE_SEGMENTS];    /** Segmenty malé hodnoty uložené přímo v instanci. */
+    int negative;                               /** 1 pokud je hodnota záporná, jinak 0. */
 } mpt;
 
+/**
+ * @brief Vrátí ukazatel na nejnižší segment instance mpt (ne ukazatele na ni), přes který mohou výpočetní smyčky
+ *        procházet segmenty přímo bez volání přístupových funkcí. Segmenty jsou souvislé, platné jsou indexy 0 až size - 1.
+ *        Malé hodnoty leží v instanci samotné, ukazatel je proto platný jen po dobu života instance, ze které byl získán.
+ */
+#define MPT_SEGMENTS(value) ((value).capacity ? (value).limbs : (segment_type *)(value).small)
+
 /**
  * @brief Funkce provede inicializaci instance struktury mpt.
  *        Instance bude mít jeden segment s hodnotou init_value, nebo bude neinicializovaná při neúspěšném provedení.
@@ -42,6 +143,47 @@ typedef struct mpt_ {
  */
 int mpt_init(mpt *value, const segment_type init_value);
 
+/**
+ * @brief Funkce provede inicializaci instance struktury mpt se zadaným počtem nulových segmentů a kladným znaménkem.
+ *        Používá se v matematických operacích, které znají potřebnou velikost výsledku předem a zapisují do segmentů přímo.
+ *        Už inicializovaná instance si ponechá svou paměť, pokud se do ní segmenty vejdou a nesdílí ji s jinou instancí,
+ *        jinak se jí vzdá a alokuje novou.
+ *        Po zapsání segmentů je nutné instanci normalizovat funkcí mpt_optimize.
+ * @param value Ukazatel na prázdnou (size 0) nebo inicializovanou instanci struktury mpt.
+ * @param segments Počet segmentů (alespoň 1).
+ * @return int 1, pokud inicializace proběhla v pořádku, jinak 0 (instance pak zůstane prázdná).
+ */
+int mpt_init_segments(mpt *value, const size_t segments);
+
+/**
+ * @brief Změní počet segmentů instance mpt. Segmenty pod původní velikostí zůstanou zachované, nové segmenty jsou nulové.
+ *        Paměť se jen zvětšuje, a to aspoň dvojnásobně, opakované zvětšování o málo segmentů se tak realokuje jen zřídka.
+ *        Segmenty sdílené s jinou instancí se zkopírují do vlastního bloku, po změně velikosti do nich lze zapisovat.
+ *        Prázdnou instanci inicializuje nulovými segmenty s kladným znaménkem. Po zmenšení je nutné instanci normalizovat funkcí mpt_optimize.
+ * @param value Ukazatel na prázdnou nebo inicializovanou instanci mpt.
+ * @param segments Nový počet segmentů (alespoň 1).
+ * @return int 1 pokud se změna podařila, 0 pokud ne (instance pak zůstane nezměněná).
+ */
+int mpt_resize(mpt *value, const size_t segments);
+
+/**
+ * @brief Funkce provede inicializaci instance struktury mpt hodnotou typu long (včetně záporných hodnot).
+ * @param value Ukazatel na instanci struktury mpt.
+ * @param init_value Výchozí hodnota inicializované instance mpt.
+ * @return int 1, pokud inicializace proběhla v pořádku, jinak 0.
+ */
+int mpt_init_long(mpt *value, const long init_value);
+
+/**
+ * @brief Zjistí, zda se hodnota instance mpt vejde do typu long, a pokud ano, zapíše ji do '*out'.
+ *        Hodnotu, která má víc segmentů, než kolik se jich do typu long vejde, považuje za nevejdoucí se,
+ *        proto by instance měla být optimalizovaná (viz mpt_optimize).
+ * @param value Instance mpt.
+ * @param out Ukazatel, kam se zapíše hodnota.
+ * @return int 1 pokud se hodnota do typu long vejde, jinak 0.
+ */
+int mpt_get_long(const mpt value, long *out);
+
 /**
  * @brief Alokuje novou instanci mpt se zadanou hodnotou.
  * @param init_value Počáteční hodnota.
@@ -51,7 +193,9 @@ mpt *mpt_allocate(const segment_type init_value);
 
 /**
  * @brief Inicializuje instanci mpt 'dest' tak, aby obsahovala stejnou hodnotou jako má 'orig'.
- * @param dest Ukazatel na instanci mpt, do níž se 
+ *        Segmenty na haldě se nekopírují, 'dest' je s 'orig' sdílí a zkopírují se až před zápisem do jedné z nich,
+ *        klon velké hodnoty tak stojí konstantní čas. Malá hodnota se zkopíruje do instance, 'orig' smí být přímo hodnota '*dest'.
+ * @param dest Ukazatel na prázdnou nebo inicializovanou instanci mpt, do níž se hodnota zkopíruje.
  * @param orig Instance mpt, která má být naklonovaná.
  * @return int 1 při úspěšném naklonování, jinak 0.
  */
@@ -65,6 +209,14 @@ int mpt_clone(mpt *dest, const mpt orig);
  */
 void mpt_replace(mpt *to_replace, mpt *replace_with);
 
+/**
+ * @brief Prohodí obsah dvou instancí mpt bez kopírování segmentů na haldě. Na rozdíl od mpt_replace nic neuvolní,
+ *        smyčky, které střídavě zapisují do dvou instancí, tak znovu využívají jejich paměť.
+ * @param a Ukazatel na první instanci mpt.
+ * @param b Ukazatel na druhou instanci mpt.
+ */
+void mpt_swap(mpt *a, mpt *b);
+
 /**
  * @brief Vrátí počet bitů v jednom segmentu instance mpt.
  * @param value Instance mpt.
@@ -73,38 +225,40 @@ void mpt_replace(mpt *to_replace, mpt *replace_with);
 size_t mpt_bits_in_segment(const mpt value);
 
 /**
- * @brief Vrátí počet segmentů v instanci mpt.
+ * @brief Vrátí počet segmentů absolutní hodnoty v instanci mpt.
  * @param value Instance mpt.
- * @return size_t Počet segmentů v instanci mpt.
+ * @return size_t Počet segmentů absolutní hodnoty v instanci mpt.
  */
 size_t mpt_segment_count(const mpt value);
 
 /**
- * @brief Vrátí počet bitů v instanci mpt.
+ * @brief Vrátí počet bitů v segmentech absolutní hodnoty instance mpt.
  * @param value Instance mpt.
- * @return size_t Počet bitů v instanci mpt.
+ * @return size_t Počet bitů v segmentech absolutní hodnoty instance mpt.
  */
 size_t mpt_bit_count(const mpt value);
 
 /**
- * @brief Vrátí ukazatel na at-tý segment v instanci mpt.
- * @param value Instance mpt.
+ * @brief Vrátí ukazatel na at-tý segment absolutní hodnoty v instanci mpt. Instance se předává ukazatelem, protože segmenty
+ *        malých hodnot leží přímo v ní a ukazatel do kopie instance by po jejím zániku nebyl platný.
+ *        Zapisovat přes ukazatel lze jen po mpt_init_segments nebo mpt_resize, jinak mohou být segmenty sdílené.
+ * @param value Ukazatel na instanci mpt.
  * @param at Index segmentu.
  * @return segment_type* Ukazatel na at-tý segment v instanci mpt, NULL pokud je at mimo rozsah.
  */
-segment_type *mpt_get_segment_ptr(const mpt value, const size_t at);
+segment_type *mpt_get_segment_ptr(const mpt *value, const size_t at);
 
 /**
- * @brief Vrátí at-tý segment v instanci mpt.
+ * @brief Vrátí at-tý segment absolutní hodnoty v instanci mpt.
  * @param value Instance mpt.
  * @param at Index segmentu.
- * @return segment_type At-tý segment v instanci mpt. Pokud je at mimo rozsah, vrátí buď 0x00 nebo 0xff, podle toho jestli je hodnota v mpt kladná nebo záporná.
+ * @return segment_type At-tý segment absolutní hodnoty v instanci mpt, 0 pokud je at mimo rozsah.
  */
 segment_type mpt_get_segment(const mpt value, const size_t at);
 
 /**
- * @brief Nastaví at-tý bit v instanci mpt na 0 pokud je bit_set roven nule, jinak na 1.
- *        Pokud je at mimo rozsah, přidá chybějící segmenty.
+ * @brief Nastaví at-tý bit absolutní hodnoty v instanci mpt na 0 pokud je bit_set roven nule, jinak na 1.
+ *        Pokud je at mimo rozsah, přidá chybějící segmenty. Po nulování bitů je nutné instanci normalizovat funkcí mpt_optimize.
  * @param value Instance mpt.
  * @param at Index bitu.
  * @param bit_set Na jakou hodnotu má být bit nastaven.
@@ -113,8 +267,8 @@ segment_type mpt_get_segment(const mpt value, const size_t at);
 int mpt_set_bit_to(mpt *value, const size_t at, const int bit_set);
 
 /**
- * @brief Zjistí hodnotu at-tého bitu v instanci mpt.
- *        Pokud je at mimo rozsah, vrátí MSB.
+ * @brief Zjistí hodnotu at-tého bitu absolutní hodnoty v instanci mpt.
+ *        Pokud je at mimo rozsah, vrátí 0.
  * @param value Instance mpt.
  * @param at Index bitu.
  * @return int 1 pokud je at-tý bit nastaven, jinak 0.
@@ -122,7 +276,7 @@ int mpt_set_bit_to(mpt *value, const size_t at, const int bit_set);
 int mpt_get_bit(const mpt value, const size_t at);
 
 /**
- * @brief Zjistí hodnotu MSB v instanci mpt.
+ * @brief Zjistí hodnotu MSB, kterou by hodnota instance mpt měla v doplňkovém kódu, tedy její znaménko.
  * @param value Instance mpt.
  * @return int 1 pokud je MSB nastaven, jinak 0.
  */
@@ -150,7 +304,8 @@ int mpt_is_negative(const mpt value);
 int mpt_is_odd(const mpt value);
 
 /**
- * @brief Optimalizuje zadanou instanci mpt, aby měla co nejmenší možný počet segmentů potřebných k reprezentaci její hodnoty.
+ * @brief Normalizuje zadanou instanci mpt: odebere nulové segmenty nejvyšších řádů absolutní hodnoty
+ *        a nule nastaví kladné znaménko. Nic nealokuje ani nekopíruje.
  * @param orig Ukazatel na instanci mpt, která má být optimalizována.
  * @return int 1 pokud se optimalizace povede, 0 pokud ne
  */
@@ -158,6 +313,7 @@ int mpt_optimize(mpt *orig);
 
 /**
  * @brief Funkce uvolní prostředy držené mpt, na kterou ukazuje pointer `value`. Využívá se hlavně pro případy, kdy je instance alokována na zásobníku.
+ *        Neinicializovanou instanci lze označit nastavením 'size' na 0, deinicializace ji pak nechá být.
  * @param value Ukazatel na instanci mpt.
  */
 void mpt_deinit(mpt *value);
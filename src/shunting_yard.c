@@ -1,3 +1,5 @@
+#include <stdlib.h>
+#include <limits.h>
 #include "shunting_yard.h"
 #include "data_structures/conversion.h"
 
@@ -6,6 +8,27 @@
 
 static int shunt_char_(const char **str, char *last_operator, vector_type *rpn_str, stack_type *operator_stack, vector_type *values_vector);
 
+/**
+ * @brief Druhý výsledek posledního dělení při vyhodnocování RPN výrazu. Operátory '/' a '%' počítají
+ *        podíl i zbytek najednou, a pokud se na stejné operandy použije i druhý operátor, výsledek se už nepočítá znovu.
+ */
+typedef struct division_cache_ {
+    char operator;      /** Operátor, jehož výsledek je uložen v 'result', nebo 0, pokud je mezipaměť prázdná. */
+    mpt dividend;       /** Dělenec posledního dělení. */
+    mpt divisor;        /** Dělitel posledního dělení. */
+    mpt result;         /** Podíl nebo zbytek, který zatím nebyl použit. */
+} division_cache;
+
+/**
+ * @brief Hodnota na zásobníku při vyhodnocování RPN výrazu. Hodnoty, které se vejdou do typu long, se počítají přímo
+ *        v něm bez alokace. Na instanci mpt se hodnota převede, až když výsledek operace typ long přeteče.
+ */
+typedef struct rpn_value_ {
+    int is_word;        /** 1 pokud je hodnota uložena ve 'word', 0 pokud v 'big'. */
+    long word;          /** Hodnota, pokud se vejde do typu long. */
+    mpt big;            /** Hodnota, pokud se do typu long nevejde (jinak neinicializovaná). */
+} rpn_value;
+
 /**
  * \brief Obalovací funkce pro funkci deinicializace instance mpt.
  * \param poor Ukazatel na instanci mpt.
@@ -14,6 +37,14 @@ static void mpt_deinit_wrapper_(void *poor) {
     mpt_deinit(poor);
 }
 
+/**
+ * \brief Obalovací funkce pro uvolnění hodnoty na zásobníku vyhodnocování.
+ * \param poor Ukazatel na instanci rpn_value.
+ */
+static void rpn_value_deinit_wrapper_(void *poor) {
+    mpt_deinit(&((rpn_value *)poor)->big);
+}
+
 /** 
  * \brief Zjistí, jestli je znak ukončující, tedy nulový nebo '\n'
  * \param c Znak.
@@ -119,7 +150,7 @@ static int push_operator_(const char operator, vector_type *rpn_str, stack_type
  */
 static int shunt_value_(const char **str, char *last_operator, vector_type *rpn_str, vector_type *values_vector) {
     mpt parsed_value;
-    parsed_value.list = NULL;
+    parsed_value.size = 0;
     
     if (!last_operator) {
         return 0;
@@ -334,18 +365,302 @@ static int get_math_error_bi_func_(const char operator, const mpt b) {
 }
 
 /**
- * @brief Provede příslušnou operaci nad znakem RPN výrazu.
+ * \brief Uvolní hodnoty uložené v mezipaměti dělení a označí ji jako prázdnou.
+ * \param cache Ukazatel na mezipaměť dělení.
+ */
+static void division_cache_clear_(division_cache *cache) {
+    mpt_deinit(&cache->dividend);
+    mpt_deinit(&cache->divisor);
+    mpt_deinit(&cache->result);
+    cache->operator = 0;
+}
+
+/**
+ * \brief Vyhodnotí operátor '/' nebo '%'. Podíl i zbytek spočte jedním voláním mpt_divmod, výsledek druhého
+ *        operátoru si spolu s operandy uloží do mezipaměti a při následujícím dělení stejných hodnot ho jen převezme.
+ *        Instance operandů přebírá: buď je uloží do mezipaměti, nebo je deinicializuje.
+ * \param c Znak operátoru ('/' nebo '%').
+ * \param result Ukazatel na instanci mpt, do které se zapíše výsledek.
+ * \param a Ukazatel na instanci mpt s dělencem.
+ * \param b Ukazatel na instanci mpt s dělitelem.
+ * \param cache Ukazatel na mezipaměť dělení.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí operací mpt.
+ * \return int RESULT_OK pokud se operace podařila, jinak hodnota některého z maker pro matematický error.
+ */
+static int evaluate_division_(const char c, mpt *result, mpt *a, mpt *b, division_cache *cache, mpt_ctx *ctx) {
+    mpt other;
+    other.size = 0;
+
+    if (mpt_is_zero(*b)) {
+        return DIV_BY_ZERO;
+    }
+
+    if (cache->operator == c && mpt_compare(cache->dividend, *a) == 0 && mpt_compare(cache->divisor, *b) == 0) {
+        *result = cache->result;
+        cache->result.size = 0;
+        division_cache_clear_(cache);
+        mpt_deinit(a);
+        mpt_deinit(b);
+        return RESULT_OK;
+    }
+
+    if (!(c == '/' ? mpt_divmod_ctx(result, &other, *a, *b, ctx) : mpt_divmod_ctx(&other, result, *a, *b, ctx))) {
+        return MATH_ERROR;
+    }
+
+    division_cache_clear_(cache);
+    cache->operator = c == '/' ? '%' : '/';
+    cache->dividend = *a;
+    cache->divisor = *b;
+    cache->result = other;
+    a->size = b->size = 0;
+
+    return RESULT_OK;
+}
+
+/**
+ * \brief Sečte dvě hodnoty typu long.
+ * \return int 1 pokud se výsledek vejde do typu long, 0 při přetečení.
+ */
+static int word_add_(const long a, const long b, long *result) {
+    if (b > 0 ? a > LONG_MAX - b : a < LONG_MIN - b) {
+        return 0;
+    }
+    *result = a + b;
+    return 1;
+}
+
+/**
+ * \brief Odečte dvě hodnoty typu long.
+ * \return int 1 pokud se výsledek vejde do typu long, 0 při přetečení.
+ */
+static int word_sub_(const long a, const long b, long *result) {
+    if (b < 0 ? a > LONG_MAX + b : a < LONG_MIN + b) {
+        return 0;
+    }
+    *result = a - b;
+    return 1;
+}
+
+/**
+ * \brief Vynásobí dvě hodnoty typu long. Absolutní hodnoty násobí bez znaménka, dělením kontroluje přetečení
+ *        jen tehdy, když některý z činitelů nemá nejvyšší polovinu bitů nulovou.
+ * \return int 1 pokud se výsledek vejde do typu long, 0 při přetečení.
+ */
+static int word_mul_(const long a, const long b, long *result) {
+    const unsigned long half = (unsigned long)1 << (sizeof(long) * BITS_IN_BYTE / 2);
+    unsigned long ua, ub, product;
+
+    ua = a < 0 ? 0UL - (unsigned long)a : (unsigned long)a;
+    ub = b < 0 ? 0UL - (unsigned long)b : (unsigned long)b;
+
+    if ((ua >= half || ub >= half) && ua != 0 && ub > ULONG_MAX / ua) {
+        return 0;
+    }
+    product = ua * ub;
+
+    if ((a < 0) != (b < 0)) {
+        if (product > (unsigned long)LONG_MAX + 1) {
+            return 0;
+        }
+        *result = product == (unsigned long)LONG_MAX + 1 ? LONG_MIN : -(long)product;
+    } else {
+        if (product > (unsigned long)LONG_MAX) {
+            return 0;
+        }
+        *result = (long)product;
+    }
+    return 1;
+}
+
+/**
+ * \brief Umocní hodnotu typu long binárním umocňováním. Záporný exponent dá 0 stejně jako mpt_pow.
+ * \return int 1 pokud se výsledek vejde do typu long, 0 při přetečení.
+ */
+static int word_pow_(long base, long exponent, long *result) {
+    long x = 1;
+
+    if (exponent < 0) {
+        *result = 0;
+        return 1;
+    }
+
+    for (;;) {
+        if ((exponent & 1) && !word_mul_(x, base, &x)) {
+            return 0;
+        }
+        if ((exponent >>= 1) == 0) {
+            break;
+        }
+        if (!word_mul_(base, base, &base)) {
+            return 0;
+        }
+    }
+
+    *result = x;
+    return 1;
+}
+
+/**
+ * \brief Provede operaci se dvěma operandy nad hodnotami typu long. Dělení nulou a výsledky, které by typ long
+ *        přetekly, nechá na výpočtu v mpt, který je obslouží včetně chybových stavů.
+ * \param c Znak operátoru.
+ * \param a První operand.
+ * \param b Druhý operand.
+ * \param result Ukazatel, kam se zapíše výsledek.
+ * \return int 1 pokud se výsledek spočetl v typu long, jinak 0.
+ */
+static int word_bi_func_(const char c, const long a, const long b, long *result) {
+    ldiv_t division;
+
+    switch (c) {
+        case '+': return word_add_(a, b, result);
+        case '-': return word_sub_(a, b, result);
+        case '*': return word_mul_(a, b, result);
+        case '^': return word_pow_(a, b, result);
+        case '/':
+        case '%':
+            if (b == 0 || (a == LONG_MIN && b == -1)) {
+                return 0;
+            }
+            /* ldiv zaokrouhluje podíl k nule a zbytek má znaménko dělence, stejně jako mpt_divmod */
+            division = ldiv(a, b);
+            *result = c == '/' ? division.quot : division.rem;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief Provede operaci s jedním operandem nad hodnotou typu long. Přetečení a faktoriál záporného čísla nechá na výpočtu v mpt.
+ * \param c Znak operátoru.
+ * \param a Operand.
+ * \param result Ukazatel, kam se zapíše výsledek.
+ * \return int 1 pokud se výsledek spočetl v typu long, jinak 0.
+ */
+static int word_un_func_(const char c, const long a, long *result) {
+    long i, x = 1;
+
+    switch (c) {
+        case RPN_UNARY_MINUS_SYMBOL:
+            if (a == LONG_MIN) {
+                return 0;
+            }
+            *result = -a;
+            return 1;
+        case '!':
+            if (a < 0) {
+                return 0;
+            }
+            for (i = 2; i <= a; ++i) {
+                if (!word_mul_(x, i, &x)) {
+                    return 0;
+                }
+            }
+            *result = x;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief Převede hodnotu ze zásobníku vyhodnocování na instanci mpt, pokud je uložená v typu long.
+ * \param value Ukazatel na hodnotu.
+ * \return int 1 pokud se převod podařil, 0 pokud ne.
+ */
+static int rpn_value_promote_(rpn_value *value) {
+    if (value->is_word) {
+        if (!mpt_init_long(&value->big, value->word)) {
+            return 0;
+        }
+        value->is_word = 0;
+    }
+    return 1;
+}
+
+/**
+ * \brief Převede hodnotu ze zásobníku vyhodnocování do typu long, pokud se do něj vejde, a uvolní její instanci mpt.
+ * \param value Ukazatel na hodnotu.
+ */
+static void rpn_value_demote_(rpn_value *value) {
+    if (!value->is_word && mpt_get_long(value->big, &value->word)) {
+        mpt_deinit(&value->big);
+        value->is_word = 1;
+    }
+}
+
+/**
+ * \brief Provede operaci nad instancemi mpt. Operandy se předávají jako hodnoty ze zásobníku vyhodnocování,
+ *        které se na instance mpt nejdřív převedou. Násobení, dělení a umocňování berou pomocnou paměť z kontextu,
+ *        ostatní operace se provedou obslužnou funkcí operátoru. Kromě dělení se výsledek zapíše přímo do instance
+ *        prvního operandu, kterou operace spotřebuje, a znovu tak využije její paměť.
+ * \param function Ukazatel na operátor.
+ * \param result Ukazatel na prázdnou instanci mpt, která převezme výsledek.
+ * \param a Ukazatel na první operand. Při úspěchu se jeho instance přesune do výsledku a zůstane prázdná.
+ * \param b Ukazatel na druhý operand, NULL u operací s jedním operandem.
+ * \param cache Ukazatel na mezipaměť dělení.
+ * \param ctx Ukazatel na kontext s pomocnou pamětí operací mpt.
+ * \return int RESULT_OK pokud se operace podařila, jinak hodnota některého z maker pro error.
+ */
+static int evaluate_mpt_(const func_oper_type *function, mpt *result, rpn_value *a, rpn_value *b, division_cache *cache, mpt_ctx *ctx) {
+    const char c = function->operator;
+    mpt *dest = &a->big;
+    int res, done;
+
+    if (!rpn_value_promote_(a) || (b && !rpn_value_promote_(b))) {
+        return ERROR;
+    }
+
+    if (b && (c == '/' || c == '%')) {
+        return evaluate_division_(c, result, &a->big, &b->big, cache, ctx);
+    }
+
+    /* Operace smí zapisovat do instance svého operandu (viz multiple_precision_operations.h), výsledek se proto
+       spočte přímo do prvního operandu a nová instance se alokuje, jen když se do něj nevejde */
+    if (!b) {
+        /* Neúspěšná operace může operand uvolnit, druh chyby se proto zjistí předem */
+        res = get_math_error_un_func_(c, a->big);
+        done = function->un_handler(dest, a->big);
+    } else if (c == '*') {
+        /* Součin dvou stejných hodnot (např. x*x) se spočte rychlejším umocněním na druhou */
+        res = MATH_ERROR;
+        done = mpt_compare(a->big, b->big) == 0 ? mpt_sqr_ctx(dest, a->big, ctx) : mpt_mul_ctx(dest, a->big, b->big, ctx);
+    } else if (c == '^') {
+        res = MATH_ERROR;
+        done = mpt_pow_ctx(dest, a->big, b->big, ctx);
+    } else {
+        res = get_math_error_bi_func_(c, b->big);
+        done = function->bi_handler(dest, a->big, b->big);
+    }
+
+    if (!done) {
+        return res;
+    }
+
+    *result = a->big;
+    a->big.size = 0;
+    return RESULT_OK;
+}
+
+/**
+ * @brief Provede příslušnou operaci nad znakem RPN výrazu. Pokud jsou operandy i výsledek v rozsahu typu long,
+ *        počítá se bez alokace přímo v něm, jinak se operandy převedou na instance mpt.
  * @param c Znak RPN výrazu.
  * @param rpn_values Ukazatel na zásobník, který obsahuje ukazatele na instance mpt s hodnotami v RPN výrazu.
- * @param values_stack Ukazatel na zásobník, který obsahuje ukazatele na instance mpt s hodnotami pro vyhodnocování RPN výrazu.
+ * @param values_stack Ukazatel na zásobník, který obsahuje hodnoty rpn_value pro vyhodnocování RPN výrazu.
  *                     V průběhu vyhodnocování bude funkce v zásobníku hodnoty odstraňovat a přidávat.
+ * @param cache Ukazatel na mezipaměť dělení.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí operací mpt.
  * @return int s hodnotou některého z maker pro úspěšnost výsledku.
  */
-static int evaluate_rpn_char_(const char c, stack_type *rpn_values, stack_type *values_stack) {
+static int evaluate_rpn_char_(const char c, stack_type *rpn_values, stack_type *values_stack, division_cache *cache, mpt_ctx *ctx) {
     int res = RESULT_OK;
     const func_oper_type *function = NULL;
-    mpt a, b, result;
-    a.list = b.list = result.list = NULL;
+    rpn_value a, b, result;
+    a.is_word = b.is_word = result.is_word = 0;
+    a.big.size = b.big.size = result.big.size = 0;
 
     #define EXIT_IF(v, e) \
         if (v) { \
@@ -353,13 +668,13 @@ static int evaluate_rpn_char_(const char c, stack_type *rpn_values, stack_type *
             goto clean_and_exit; \
         }
 
-    EXIT_IF(!rpn_values || !values_stack, ERROR);
+    EXIT_IF(!rpn_values || !values_stack || !cache, ERROR);
 
     EXIT_IF(c == '(', SYNTAX_ERROR);
 
     if (c == RPN_VALUE_SYMBOL) {
-        EXIT_IF(!stack_pop(rpn_values, &a) || !stack_push(values_stack, &a), ERROR);
-        return RESULT_OK;
+        EXIT_IF(!stack_pop(rpn_values, &result.big), ERROR);
+        goto clean_and_exit;
     }
 
     function = get_func_operator(c);
@@ -367,22 +682,37 @@ static int evaluate_rpn_char_(const char c, stack_type *rpn_values, stack_type *
 
     if (function->bi_handler) {
         EXIT_IF(!stack_pop(values_stack, &b) || !stack_pop(values_stack, &a), SYNTAX_ERROR);
-        EXIT_IF(!function->bi_handler(&result, a, b), get_math_error_bi_func_(c, b));
+
+        if (a.is_word && b.is_word && word_bi_func_(c, a.word, b.word, &result.word)) {
+            result.is_word = 1;
+        } else {
+            EXIT_IF((res = evaluate_mpt_(function, &result.big, &a, &b, cache, ctx)) != RESULT_OK, res);
+        }
     }
     else if (function->un_handler) {
         EXIT_IF(!stack_pop(values_stack, &a), SYNTAX_ERROR);
-        EXIT_IF(!function->un_handler(&result, a), get_math_error_un_func_(c, a));
+
+        if (a.is_word && word_un_func_(c, a.word, &result.word)) {
+            result.is_word = 1;
+        } else {
+            EXIT_IF((res = evaluate_mpt_(function, &result.big, &a, NULL, cache, ctx)) != RESULT_OK, res);
+        }
     }
     else {
         return ERROR;
     }
 
   clean_and_exit:
-    mpt_deinit(&a);
-    mpt_deinit(&b);
-
-    if (res == RESULT_OK && !stack_push(values_stack, &result)) {
-        return ERROR;
+    mpt_deinit(&a.big);
+    mpt_deinit(&b.big);
+
+    if (res == RESULT_OK) {
+        /* Výsledek, který se do typu long znovu vejde, se dál počítá bez alokací */
+        rpn_value_demote_(&result);
+        if (!stack_push(values_stack, &result)) {
+            mpt_deinit(&result.big);
+            return ERROR;
+        }
     }
     return res;
 
@@ -392,6 +722,7 @@ static int evaluate_rpn_char_(const char c, stack_type *rpn_values, stack_type *
 int shunt(const char *str, vector_type **rpn_str, stack_type **values) {
     int res = SYNTAX_OK;
     char c, last_operator = 0;
+    size_t operators;
     stack_type *operator_stack = NULL;
     vector_type *values_vector = NULL;
 
@@ -403,12 +734,16 @@ int shunt(const char *str, vector_type **rpn_str, stack_type **values) {
 
     EXIT_IF(!str || is_end_char_(*str) || !rpn_str || !values, ERROR);
 
-    operator_stack = stack_allocate(get_operator_count_(str), sizeof(char), NULL);
+    operators = get_operator_count_(str);
+    operator_stack = stack_allocate(operators, sizeof(char), NULL);
     values_vector = vector_allocate(sizeof(mpt), mpt_deinit_wrapper_);
     *rpn_str = vector_allocate(sizeof(char), NULL);
 
     EXIT_IF(!operator_stack || !*rpn_str || !values_vector, ERROR);
 
+    /* Hodnot je nejvýše o jednu víc než operátorů, RPN výraz se tak obvykle sestaví bez realokací */
+    EXIT_IF(!vector_reserve(values_vector, operators + 1) || !vector_reserve(*rpn_str, 2 * operators + 1), ERROR);
+
     for (; !is_end_char_(*str); ++str) {
         EXIT_IF((res = shunt_char_(&str, &last_operator, *rpn_str, operator_stack, values_vector)) != SYNTAX_OK, res);
     }
@@ -434,11 +769,15 @@ int shunt(const char *str, vector_type **rpn_str, stack_type **values) {
     #undef EXIT_IF
 }
 
-int evaluate_rpn(mpt *dest, const vector_type *rpn_str, stack_type *values) {
+int evaluate_rpn(mpt *dest, const vector_type *rpn_str, stack_type *values, mpt_ctx *ctx) {
     int res = RESULT_OK;
     char *c;
     size_t i;
     stack_type *stack_values = NULL;
+    rpn_value result;
+    division_cache cache;
+    cache.operator = 0;
+    cache.dividend.size = cache.divisor.size = cache.result.size = 0;
 
     #define EXIT_IF(v, e) \
         if (v) { \
@@ -448,17 +787,20 @@ int evaluate_rpn(mpt *dest, const vector_type *rpn_str, stack_type *values) {
 
     EXIT_IF(!dest || !rpn_str || !values, ERROR);
 
-    EXIT_IF(!(stack_values = stack_allocate(stack_item_count(values), values->item_size, mpt_deinit_wrapper_)), ERROR);
+    EXIT_IF(!(stack_values = stack_allocate(stack_item_count(values), sizeof(rpn_value), rpn_value_deinit_wrapper_)), ERROR);
 
     for (i = 0; i < vector_count(rpn_str); ++i) {
         EXIT_IF(!(c = (char *)vector_at(rpn_str, i)), ERROR);
-        EXIT_IF((res = evaluate_rpn_char_(*c, values, stack_values)) != RESULT_OK, res);
+        EXIT_IF((res = evaluate_rpn_char_(*c, values, stack_values, &cache, ctx)) != RESULT_OK, res);
     }
 
     EXIT_IF(stack_item_count(stack_values) != 1, SYNTAX_ERROR);
-    EXIT_IF(!stack_pop(stack_values, dest), ERROR);
+    EXIT_IF(!stack_pop(stack_values, &result), ERROR);
+    EXIT_IF(!rpn_value_promote_(&result), ERROR);
+    *dest = result.big;
     
   clean_and_exit:
+    division_cache_clear_(&cache);
     stack_deallocate(&stack_values);
     return res;
 
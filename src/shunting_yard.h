@@ -52,8 +52,9 @@ int shunt(const char *str, vector_type **rpn_str, stack_type **rpn_values);
  * @param rpn_str Ukazatel na vektor, který obsahuje řetězec s RPN výrazem.
  * @param rpn_values Ukazatel na zásobník, který obsahuje ukazatele na instance mpt s hodnotami pro RPN.
  *                   V průběhu vyhodnocování bude ze zásobníku hodnoty odstraňovat.
+ * @param ctx Ukazatel na kontext s pomocnou pamětí operací mpt, nebo NULL.
  * @return int s hodnotou některého z maker pro úspěšnost výsledku.
  */
-int evaluate_rpn(mpt *dest, const vector_type *rpn_str, stack_type *rpn_values);
+int evaluate_rpn(mpt *dest, const vector_type *rpn_str, stack_type *rpn_values, mpt_ctx *ctx);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,219 @@
+/**
+ * @file mpt_bench.c
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Měřicí nástroj, který změří doby základních operací nad hodnotami o zadaném počtu bitů.
+ *        Velikosti operandů jsou v bitech, výsledky sestavení s různou šířkou segmentu (-DMPT_SEGMENT_BITS=32 nebo 64)
+ *        jsou proto přímo porovnatelné. CMake sestaví obě varianty jako mpt_bench (výchozí šířka) a mpt_bench32.
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../mpt/mpt.h"
+
+/** Nejmenší doba jednoho měření v sekundách, kratší měření jsou zatížena příliš velkou chybou. */
+#define MIN_MEASURE_TIME 0.05
+
+/** Počet měřených velikostí operandů. */
+#define BENCH_SIZES 4
+
+/** Počet měřených operací. */
+#define BENCH_OPERATIONS 6
+
+/** Měřené velikosti operandů v bitech (násobky 64, aby se vešly do celých segmentů obou šířek). */
+static const size_t bench_bits_[BENCH_SIZES] = { 256, 4096, 65536, 1048576 };
+
+/**
+ * @brief Operandy jednoho měření.
+ */
+typedef struct bench_operands_ {
+    mpt a;                  /** Kladná hodnota o zadaném počtu bitů. */
+    mpt b;                  /** Jiná kladná hodnota o zadaném počtu bitů. */
+    mpt wide;               /** Kladná hodnota o dvojnásobném počtu bitů (dělenec). */
+    char *digits;           /** Dekadický zápis hodnoty o zadaném počtu bitů. */
+} bench_operands;
+
+/** @brief Definice ukazatele na funkci, která provede měřenou operaci a výsledek zapíše do 'dest'. */
+typedef int (*bench_operation)(mpt *, const bench_operands *);
+
+/** \brief Sečte operandy a a b. */
+static int bench_add_(mpt *dest, const bench_operands *ops) {
+    return mpt_add(dest, ops->a, ops->b);
+}
+
+/** \brief Vynásobí operandy a a b. */
+static int bench_mul_(mpt *dest, const bench_operands *ops) {
+    return mpt_mul(dest, ops->a, ops->b);
+}
+
+/** \brief Umocní operand a na druhou. */
+static int bench_sqr_(mpt *dest, const bench_operands *ops) {
+    return mpt_sqr(dest, ops->a);
+}
+
+/** \brief Vydělí dvojnásobně dlouhý operand operandem a. */
+static int bench_div_(mpt *dest, const bench_operands *ops) {
+    return mpt_div(dest, ops->wide, ops->a);
+}
+
+/** \brief Vydělí operand a hodnotou DEC_CHUNK_BASE (jeden krok dekadického výpisu). */
+static int bench_divmod_ui_(mpt *dest, const bench_operands *ops) {
+    segment_type remainder;
+    return mpt_divmod_ui(dest, &remainder, ops->a, DEC_CHUNK_BASE);
+}
+
+/** \brief Naparsuje dekadický zápis hodnoty. */
+static int bench_parse_dec_(mpt *dest, const bench_operands *ops) {
+    const char *str = ops->digits;
+    return mpt_parse_str_dec(dest, &str);
+}
+
+/** Měřené operace. */
+static const bench_operation bench_operations_[BENCH_OPERATIONS] = {
+    bench_add_, bench_mul_, bench_sqr_, bench_div_, bench_divmod_ui_, bench_parse_dec_
+};
+
+/** Názvy měřených operací pro výpis. */
+static const char *bench_names_[BENCH_OPERATIONS] = {
+    "add [us]", "mul [us]", "sqr [us]", "div [us]", "divmod_ui [us]", "parse dec [us]"
+};
+
+/**
+ * \brief Inicializuje instanci mpt pseudonáhodnou kladnou hodnotou o zadaném počtu bitů.
+ * \param value Ukazatel na neinicializovanou instanci mpt.
+ * \param bits Počet bitů hodnoty (násobek SEGMENT_BITS).
+ * \return int 1 pokud se inicializace podařila, jinak 0.
+ */
+static int random_value_(mpt *value, const size_t bits) {
+    const size_t count = bits / SEGMENT_BITS;
+    segment_type *segments;
+    size_t i, j;
+
+    /* Nejvyšší segment zůstane nulový, hodnota je tak kladná */
+    if (!mpt_init_segments(value, count + 1)) {
+        return 0;
+    }
+    segments = MPT_SEGMENTS(*value);
+
+    for (i = 0; i < count; ++i) {
+        for (j = 0; j < sizeof(segment_type); ++j) {
+            segments[i] = (segments[i] << BITS_IN_BYTE) | (segment_type)(rand() & 0xff);
+        }
+    }
+    segments[count - 1] |= (segment_type)1 << (SEGMENT_BITS - 1);
+
+    return mpt_optimize(value);
+}
+
+/**
+ * \brief Vytvoří pseudonáhodný dekadický zápis s přibližně stejným počtem bitů (log10(2) < 0.30103).
+ * \param bits Počet bitů hodnoty.
+ * \return char* Alokovaný řetězec, NULL při nedostatku paměti.
+ */
+static char *random_digits_(const size_t bits) {
+    const size_t count = bits / 10 * 3 + 1;
+    char *digits = (char *)malloc(count + 1);
+    size_t i;
+
+    if (!digits) {
+        return NULL;
+    }
+
+    digits[0] = (char)('1' + rand() % 9);
+    for (i = 1; i < count; ++i) {
+        digits[i] = (char)('0' + rand() % 10);
+    }
+    digits[count] = '\0';
+
+    return digits;
+}
+
+/**
+ * \brief Změří průměrnou dobu operace.
+ * \param op Měřená operace.
+ * \param ops Operandy.
+ * \return double Průměrná doba jedné operace v sekundách, záporná při chybě.
+ */
+static double measure_(const bench_operation op, const bench_operands *ops) {
+    clock_t start, elapsed;
+    size_t i, repetitions = 1;
+    mpt res;
+    res.size = 0;
+
+    for (;;) {
+        start = clock();
+        for (i = 0; i < repetitions; ++i) {
+            if (!op(&res, ops)) {
+                return -1;
+            }
+            mpt_deinit(&res);
+        }
+        elapsed = clock() - start;
+
+        if ((double)elapsed / CLOCKS_PER_SEC >= MIN_MEASURE_TIME) {
+            return (double)elapsed / CLOCKS_PER_SEC / repetitions;
+        }
+        repetitions *= 2;
+    }
+}
+
+/**
+ * @brief Spouštěcí funkce měřicího nástroje.
+ * @return EXIT_SUCCESS pokud se měření podařilo, jinak EXIT_FAILURE.
+ */
+int main(void) {
+    int exit = EXIT_SUCCESS;
+    size_t i, j;
+    double elapsed;
+    bench_operands ops;
+    ops.a.size = ops.b.size = ops.wide.size = 0;
+    ops.digits = NULL;
+
+    #define FAIL_IF_NOT(v) \
+        if (!(v)) { \
+            printf("Out of memory!\n"); \
+            exit = EXIT_FAILURE; \
+            goto clean_and_exit; \
+        }
+
+    srand(1);
+    printf("Segment width: %lu bits\n", (unsigned long)SEGMENT_BITS);
+    printf("%10s", "bits");
+    for (j = 0; j < BENCH_OPERATIONS; ++j) {
+        printf(" %15s", bench_names_[j]);
+    }
+    printf("\n");
+
+    for (i = 0; i < BENCH_SIZES; ++i) {
+        FAIL_IF_NOT(random_value_(&ops.a, bench_bits_[i]));
+        FAIL_IF_NOT(random_value_(&ops.b, bench_bits_[i]));
+        FAIL_IF_NOT(random_value_(&ops.wide, 2 * bench_bits_[i]));
+        FAIL_IF_NOT(ops.digits = random_digits_(bench_bits_[i]));
+
+        printf("%10lu", (unsigned long)bench_bits_[i]);
+        for (j = 0; j < BENCH_OPERATIONS; ++j) {
+            FAIL_IF_NOT((elapsed = measure_(bench_operations_[j], &ops)) >= 0);
+            printf(" %15.3f", elapsed * 1e6);
+            fflush(stdout);
+        }
+        printf("\n");
+
+        mpt_deinit(&ops.a);
+        mpt_deinit(&ops.b);
+        mpt_deinit(&ops.wide);
+        free(ops.digits);
+        ops.digits = NULL;
+    }
+
+  clean_and_exit:
+    mpt_deinit(&ops.a);
+    mpt_deinit(&ops.b);
+    mpt_deinit(&ops.wide);
+    free(ops.digits);
+
+    return exit;
+
+    #undef FAIL_IF_NOT
+}
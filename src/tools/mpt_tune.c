@@ -0,0 +1,220 @@
+/**
+ * @file mpt_tune.c
+ * @author Hynek Moudrý (hmoudry@students.zcu.cz)
+ * @brief Kalibrační nástroj, který na aktuálním stroji změří nejvýhodnější prahy násobicích a dělicích algoritmů.
+ *        Pro každou velikost operandů porovná nižší algoritmus s jednou úrovní vyššího algoritmu
+ *        (školní násobení s Karatsubovým algoritmem, Karatsubův algoritmus s algoritmem Toom-3, algoritmus Toom-3 s NTT,
+ *        školní dělení s rekurzivním dělením) a vypíše nejmenší velikost, od které je vyšší algoritmus trvale rychlejší.
+ * @version 1.0
+ * @date 2023-01-04
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../mpt/mpt.h"
+
+/** Nejmenší doba jednoho měření v sekundách, kratší měření jsou zatížena příliš velkou chybou. */
+#define MIN_MEASURE_TIME 0.02
+
+/** Největší testovaná velikost činitelů v segmentech pro Karatsubův algoritmus a algoritmus Toom-3. */
+#define MAX_TUNE_SEGMENTS 1024
+
+/** Největší testovaná velikost činitelů v segmentech pro násobení pomocí NTT. */
+#define MAX_FFT_TUNE_SEGMENTS 16384
+
+/** Počet po sobě jdoucích velikostí, na kterých musí být vyšší algoritmus rychlejší. */
+#define REQUIRED_WINS 3
+
+/** @brief Definice ukazatele na funkci, která nastavuje práh jednoho z algoritmů. */
+typedef void (*threshold_setter)(const size_t);
+
+/** @brief Definice ukazatele na funkci, která provede měřenou operaci nad operandy o n segmentech. */
+typedef int (*tuned_operation)(segment_type *, const segment_type *, const segment_type *, const size_t);
+
+/**
+ * \brief Naplní pole segmentů pseudonáhodnými hodnotami.
+ * \param segments Ukazatel na segmenty.
+ * \param count Počet segmentů.
+ */
+static void fill_random_(segment_type *segments, const size_t count) {
+    size_t i, j;
+
+    for (i = 0; i < count; ++i) {
+        segments[i] = 0;
+        for (j = 0; j < sizeof(segment_type); ++j) {
+            segments[i] = (segments[i] << BITS_IN_BYTE) | (segment_type)(rand() & 0xff);
+        }
+    }
+}
+
+/**
+ * \brief Vynásobí dvě hodnoty o n segmentech.
+ */
+static int multiply_(segment_type *res, const segment_type *a, const segment_type *b, const size_t n) {
+    return mpt_mul_segments(res, a, n, b, n, NULL);
+}
+
+/**
+ * \brief Vydělí hodnotu o 2n segmentech hodnotou o n segmentech, zbytek zahodí.
+ */
+static int divide_(segment_type *res, const segment_type *a, const segment_type *b, const size_t n) {
+    return mpt_divrem_segments(res, NULL, a, 2 * n, b, n, NULL);
+}
+
+/**
+ * \brief Změří průměrnou dobu operace nad hodnotami o n segmentech při aktuálně nastavených prazích.
+ * \param op Měřená operace.
+ * \param res Ukazatel na segmenty výsledku (alespoň 2n).
+ * \param a Ukazatel na segmenty prvního operandu (alespoň 2n).
+ * \param b Ukazatel na segmenty druhého operandu.
+ * \param n Počet segmentů operandů.
+ * \return double Průměrná doba jedné operace v sekundách, záporná při chybě.
+ */
+static double measure_(const tuned_operation op, segment_type *res, const segment_type *a, const segment_type *b, const size_t n) {
+    clock_t start, elapsed;
+    size_t i, repetitions = 1;
+
+    for (;;) {
+        start = clock();
+        for (i = 0; i < repetitions; ++i) {
+            if (!op(res, a, b, n)) {
+                return -1;
+            }
+        }
+        elapsed = clock() - start;
+
+        if ((double)elapsed / CLOCKS_PER_SEC >= MIN_MEASURE_TIME) {
+            return (double)elapsed / CLOCKS_PER_SEC / repetitions;
+        }
+        repetitions *= 2;
+    }
+}
+
+/**
+ * \brief Najde nejmenší velikost operandů, od které je jedna úroveň vyššího algoritmu trvale rychlejší než nižší algoritmus.
+ *        Práh n + 1 vynutí pro operandy o n segmentech nižší algoritmus, práh n jednu úroveň vyššího algoritmu.
+ * \param op Měřená operace.
+ * \param res Ukazatel na segmenty výsledku (alespoň 2 * to).
+ * \param a Ukazatel na segmenty prvního operandu.
+ * \param b Ukazatel na segmenty druhého operandu.
+ * \param from Nejmenší testovaná velikost.
+ * \param to Největší testovaná velikost.
+ * \param set Funkce, která nastavuje práh vyššího algoritmu.
+ * \param name Název vyššího algoritmu pro výpis.
+ * \param found Ukazatel, kam se zapíše nalezený práh, nebo 0, pokud vyšší algoritmus nebyl rychlejší.
+ * \return int 1 pokud se měření podařilo, 0 pokud ne.
+ */
+static int find_threshold_(const tuned_operation op, segment_type *res, const segment_type *a, const segment_type *b, const size_t from, const size_t to,
+                           const threshold_setter set, const char *name, size_t *found) {
+    size_t n, last = 0, wins = 0;
+    double lower, higher;
+
+    *found = 0;
+    printf("%8s %14s %14s\n", "segments", "lower [us]", name);
+
+    /* Malé velikosti se procházejí po jedné, větší s krokem zhruba 1/16 velikosti */
+    for (n = from; n <= to; n += n / 16 + 1) {
+        set(n + 1);
+        lower = measure_(op, res, a, b, n);
+        set(n);
+        higher = measure_(op, res, a, b, n);
+
+        if (lower < 0 || higher < 0) {
+            return 0;
+        }
+
+        printf("%8lu %14.3f %14.3f\n", (unsigned long)n, lower * 1e6, higher * 1e6);
+
+        if (higher >= lower) {
+            wins = 0;
+            continue;
+        }
+        if (wins++ == 0) {
+            last = n;
+        }
+        if (wins == REQUIRED_WINS) {
+            *found = last;
+            return 1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Spouštěcí funkce kalibračního nástroje.
+ * @return EXIT_SUCCESS pokud se kalibrace podařila, jinak EXIT_FAILURE.
+ */
+int main(void) {
+    int exit = EXIT_SUCCESS;
+    size_t karatsuba, toom3, fft, bz, i;
+    segment_type *a, *b, *res;
+
+    a = (segment_type *)malloc(MAX_FFT_TUNE_SEGMENTS * sizeof(segment_type));
+    b = (segment_type *)malloc(MAX_FFT_TUNE_SEGMENTS * sizeof(segment_type));
+    res = (segment_type *)malloc(2 * MAX_FFT_TUNE_SEGMENTS * sizeof(segment_type));
+
+    #define FAIL_IF_NOT(v) \
+        if (!(v)) { \
+            printf("Out of memory!\n"); \
+            exit = EXIT_FAILURE; \
+            goto clean_and_exit; \
+        }
+
+    FAIL_IF_NOT(a && b && res);
+
+    srand(1);
+    fill_random_(a, MAX_FFT_TUNE_SEGMENTS);
+    fill_random_(b, MAX_FFT_TUNE_SEGMENTS);
+    /* Dělitel nesmí mít nulový nejvyšší segment, ať se měří jakákoli velikost */
+    for (i = 0; i < MAX_FFT_TUNE_SEGMENTS; ++i) {
+        b[i] |= 1;
+    }
+
+    mpt_set_toom3_threshold(MAX_TUNE_SEGMENTS + 1);
+    mpt_set_fft_threshold(MAX_FFT_TUNE_SEGMENTS + 1);
+    FAIL_IF_NOT(find_threshold_(multiply_, res, a, b, MPT_KARATSUBA_THRESHOLD_MIN, MAX_TUNE_SEGMENTS, mpt_set_karatsuba_threshold, "karatsuba [us]", &karatsuba));
+    if (!karatsuba) {
+        karatsuba = MPT_KARATSUBA_THRESHOLD;
+    }
+    mpt_set_karatsuba_threshold(karatsuba);
+
+    FAIL_IF_NOT(find_threshold_(multiply_, res, a, b, karatsuba < MPT_TOOM3_THRESHOLD_MIN ? MPT_TOOM3_THRESHOLD_MIN : karatsuba, MAX_TUNE_SEGMENTS,
+                                mpt_set_toom3_threshold, "toom-3 [us]", &toom3));
+    if (!toom3) {
+        toom3 = MPT_TOOM3_THRESHOLD;
+    }
+    mpt_set_toom3_threshold(toom3);
+
+    /* Délka transformace roste po mocninách dvou, začíná se proto až od čtvrtiny výchozího prahu */
+    FAIL_IF_NOT(find_threshold_(multiply_, res, a, b, MPT_FFT_THRESHOLD / 4 < toom3 ? toom3 : MPT_FFT_THRESHOLD / 4, MAX_FFT_TUNE_SEGMENTS,
+                                mpt_set_fft_threshold, "ntt [us]", &fft));
+    if (!fft) {
+        fft = MPT_FFT_THRESHOLD;
+    }
+    mpt_set_fft_threshold(fft);
+
+    /* Rekurzivní dělení se měří s již nastavenými prahy násobení, na kterých závisí */
+    FAIL_IF_NOT(find_threshold_(divide_, res, a, b, MPT_BZ_THRESHOLD_MIN, MAX_TUNE_SEGMENTS,
+                                mpt_set_bz_threshold, "recursive [us]", &bz));
+    if (!bz) {
+        bz = MPT_BZ_THRESHOLD;
+    }
+
+    printf("Recommended thresholds: Karatsuba %lu segments, Toom-3 %lu segments, NTT %lu segments, division %lu segments\n",
+           (unsigned long)karatsuba, (unsigned long)toom3, (unsigned long)fft, (unsigned long)bz);
+    printf("Rebuild with -DMPT_KARATSUBA_THRESHOLD=%lu -DMPT_TOOM3_THRESHOLD=%lu -DMPT_FFT_THRESHOLD=%lu -DMPT_BZ_THRESHOLD=%lu\n",
+           (unsigned long)karatsuba, (unsigned long)toom3, (unsigned long)fft, (unsigned long)bz);
+    printf("or set MPT_KARATSUBA_THRESHOLD=%lu, MPT_TOOM3_THRESHOLD=%lu, MPT_FFT_THRESHOLD=%lu and MPT_BZ_THRESHOLD=%lu in the environment of calc.\n",
+           (unsigned long)karatsuba, (unsigned long)toom3, (unsigned long)fft, (unsigned long)bz);
+
+  clean_and_exit:
+    free(a);
+    free(b);
+    free(res);
+
+    return exit;
+
+    #undef FAIL_IF_NOT
+}